@@ -0,0 +1,184 @@
+/*----------------------------------------------------------------
+ *
+ *  Written:       17/10/2026
+ *  Last updated:  17/10/2026
+ *
+ *
+ *  Runs one realization for many values of alpha (ell = alpha *
+ *  LPLANCK) at once, all driven by the same gaussian noise. Use as
+ *  follows:
+ *
+ *  std::vector<double> alphas = { 1.0, 2.5, 5.0 };
+ *  AlphaSweep<CRandomPhilox, 4> sweep(steps, seed, run, simulator.getParameters(), alphas);
+ *  AlphaSweepWriter writer("lambda-alpha.txt", alphas);
+ *  sweep.runSimulation(writer);
+ *
+ *  Separate runs per alpha draw separate noise, so the difference
+ *  between two lambda(tau) curves is mostly noise. Here the noise of
+ *  realization (seed, run) is drawn once per step and fed to every
+ *  alpha (common random numbers), so the curves differ only through
+ *  alpha. The alphas are the lanes of LaneSimulator's step, W per
+ *  vector instruction, so K alphas cost one run of draws plus K / W
+ *  vector steps. The alpha of the Simulator (2.5) gives its lambda to
+ *  rounding.
+ *
+ *  The sink gets record(i, tau, lambda) once per step, with lambda[k]
+ *  for alphas[k]. An alpha whose root became negative stops like
+ *  runSimulation and reports NAN from then on; the sweep ends when all
+ *  have stopped or after steps steps.
+ *
+ *----------------------------------------------------------------*/
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include "LaneSimulator.h"
+
+template <class RNG, int W>
+class AlphaSweep {
+
+private:
+    int steps;
+    int seed;
+    int run;
+    RNG rng;
+    GaussianBuffer noise;
+
+    SimulatorParameters params;
+    LaneConstants constants;
+    std::vector<double> alphas;
+    std::vector<int> last;      // last step of every alpha
+
+    /* alpha k is lane k % W of block k / W */
+    std::vector<LaneState<W> > blocks;
+    typename LaneKernel<W>::Step kernel;
+
+public:
+    // p: initial conditions and model parameters; p.ell is replaced by alpha * LPLANCK
+    AlphaSweep(int steps, int seed, int run, const SimulatorParameters &p, const std::vector<double> &alphas)
+        : seed(seed), run(run), rng(seed), alphas(alphas) {
+        this->steps = steps;
+        this->params = p;
+        constants = laneConstants(p);
+        last.assign(alphas.size(), 0);
+        blocks.resize((alphas.size() + W - 1) / W);
+        const char* name;
+        kernel = LaneKernel<W>::select(name);
+    }
+
+    /* run all alphas into sink.record(i, tau, lambda) */
+    template <class Sink>
+    void runSimulation(Sink &sink) {
+        TimerRegion region("alpha sweep");
+        int K = (int) alphas.size();
+        int B = (int) blocks.size();
+        std::vector<double> lambda(K);
+        std::vector<unsigned> live(B, 0);       // lanes of each block still running
+        std::vector<unsigned> stopped(B, 0);    // lanes that stopped at this step
+        for (int b = 0; b < B; b++) {
+            for (int l = 0; l < W; l++) {
+                // lanes past the last alpha repeat it and are not reported
+                int k = b * W + l;
+                laneReset(blocks[b], l, params, alphas[k < K ? k : K - 1] * LPLANCK);
+                if (k < K) live[b] |= 1u << l;
+            }
+        }
+        InitStream(rng, seed, run);
+        noise.clear();
+        for (int k = 0; k < K; k++) {
+            last[k] = 0;
+            lambda[k] = params.lambda0;
+        }
+        sink.record(0, params.tau0, &lambda[0]);
+
+        int busy = K;
+        alignas(64) double g[W];
+        for (int i = 0; i < steps - 1 && busy > 0; i++) {
+            double x = noise.next(rng);
+            for (int l = 0; l < W; l++) {
+                g[l] = x;
+            }
+            for (int b = 0; b < B; b++) {
+                if (live[b] == 0) continue;
+                stopped[b] = kernel(blocks[b], g, constants) & live[b];
+                for (int l = 0; l < W; l++) {
+                    if ((live[b] >> l) & 1) {
+                        lambda[b * W + l] = blocks[b].lambda[l];
+                        last[b * W + l] = i + 1;
+                    }
+                }
+                live[b] &= ~stopped[b];
+                busy -= __builtin_popcount(stopped[b]);
+            }
+            sink.record(i + 1, params.tau0 + (i + 1) * params.deltatau, &lambda[0]);
+            // recorded this step like runSimulation, NAN from the next
+            for (int b = 0; b < B; b++) {
+                for (int l = 0; stopped[b] != 0 && l < W; l++) {
+                    if ((stopped[b] >> l) & 1) lambda[b * W + l] = NAN;
+                }
+                stopped[b] = 0;
+            }
+        }
+    }
+
+    int getCount() const {
+        return (int) alphas.size();
+    }
+
+    double getAlpha(int k) const {
+        return alphas[k];
+    }
+
+    // last step alpha k reached (steps - 1 unless its root became negative)
+    int getLastStep(int k) const {
+        return last[k];
+    }
+};
+
+// Writes tau and lambda for every alpha, one row per step
+class AlphaSweepWriter {
+
+private:
+    FILE* ofp;
+    int count;
+
+public:
+    AlphaSweepWriter(const char* outputFilename, const std::vector<double> &alphas) {
+        ofp = fopen(outputFilename, "w");
+
+        if (ofp == NULL) {
+          fprintf(stderr, "Can't open output file %s!\n",
+                  outputFilename);
+          exit(1);
+        }
+
+        count = (int) alphas.size();
+        fprintf(ofp, "# tau");
+        for (int k = 0; k < count; k++) {
+            fprintf(ofp, "\talpha=%g", alphas[k]);
+        }
+        fprintf(ofp, "\n");
+    }
+
+    ~AlphaSweepWriter() {
+        close();
+    }
+
+    void record(int i, double tau, const double* lambda) {
+        fprintf(ofp, "%E", tau);
+        for (int k = 0; k < count; k++) {
+            fprintf(ofp, "\t%E", lambda[k]);
+        }
+        fprintf(ofp, "\n");
+    }
+
+    void close() {
+        if (ofp != NULL) {
+            fclose(ofp);
+            ofp = NULL;
+        }
+    }
+};
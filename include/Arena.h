@@ -0,0 +1,205 @@
+/*----------------------------------------------------------------
+ *
+ *  Written:       17/10/2026
+ *  Last updated:  17/10/2026
+ *
+ *
+ *  Bump allocator for the arrays of a run, reset between runs
+ *  without giving the memory back. Use as follows:
+ *
+ *  Arena &arena = Arena::local();      // one per thread
+ *  arena.reset();                      // everything allocated before is dead
+ *  double* x = arena.allocate<double>(steps);
+ *
+ *  Memory comes from the kernel in blocks of whole huge pages (2 MiB,
+ *  mmap aligned to 2 MiB and marked MADV_HUGEPAGE, so transparent
+ *  huge pages back it where they are enabled). A block smaller than
+ *  that gets normal pages instead, as zeroing a whole huge page costs
+ *  more than a short run. Every allocation is aligned to 64 bytes, a
+ *  cache line and an AVX-512 vector. reset()
+ *  only rewinds: the pages stay mapped and faulted in, so the next
+ *  run of the same size neither asks the kernel for memory nor page
+ *  faults. If a run needed more than one block, reset() replaces them
+ *  by one block of their total size; reserve() gets that block up
+ *  front when the size is known. Nothing is constructed or destroyed:
+ *  only use it for plain data.
+ *
+ *  An Arena belongs to one thread. Arena::local() is the arena of the
+ *  calling thread, for runs that follow each other on it. Whoever
+ *  resets an arena ends the allocations of everybody else, so users
+ *  that keep theirs between calls claim() it first and unclaim() it
+ *  when done; claim() fails while somebody else holds it.
+ *
+ *----------------------------------------------------------------*/
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+class Arena {
+
+public:
+    static const size_t ALIGN = 64;                 // of every allocation
+    static const size_t HUGEPAGE = 2 * 1024 * 1024; // size and alignment of large blocks
+    static const size_t PAGE = 4096;                // of small blocks
+
+private:
+    /* one mapping */
+    struct Block {
+        char* base;
+        size_t size;
+    };
+
+    // doubling from one page, so this is never reached
+    static const int MAXBLOCKS = 48;
+
+    Block blocks[MAXBLOCKS];
+    int count;          // blocks mapped
+    size_t used;        // bytes used of the last block
+    size_t mapped;      // bytes of all blocks
+    int mappings;       // blocks mapped since construction
+    const void* owner;  // holder of the claim, NULL if none
+
+    // owns its mappings
+    Arena(const Arena&);
+    Arena& operator=(const Arena&);
+
+public:
+    Arena() : count(0), used(0), mapped(0), mappings(0), owner(NULL) {
+    }
+
+    ~Arena() {
+        unmapAll();
+    }
+
+    // the arena of the calling thread
+    static Arena& local() {
+        thread_local Arena arena;
+        return arena;
+    }
+
+    // bytes rounded up to the alignment
+    static size_t aligned(size_t bytes) {
+        return (bytes + ALIGN - 1) & ~(ALIGN - 1);
+    }
+
+    /* n uninitialized T, aligned to ALIGN, valid until reset() */
+    template <class T>
+    T* allocate(size_t n) {
+        size_t bytes = aligned(n * sizeof(T));
+        if (count == 0 || used + bytes > blocks[count - 1].size) {
+            grow(bytes > mapped ? bytes : mapped);
+        }
+        char* p = blocks[count - 1].base + used;
+        used += bytes;
+        return (T*) p;
+    }
+
+    /* Make the next allocations up to bytes in total come from one block */
+    void reserve(size_t bytes) {
+        // only while nothing is allocated, as right after reset()
+        if (used != 0 || count > 1) return;
+        if (count == 1 && blocks[0].size >= bytes) return;
+        unmapAll();
+        grow(bytes);
+    }
+
+    /* Claim the arena for who; false if somebody else holds it */
+    bool claim(const void* who) {
+        if (owner != NULL && owner != who) return false;
+        owner = who;
+        return true;
+    }
+
+    void unclaim(const void* who) {
+        if (owner == who) owner = NULL;
+    }
+
+    /* Forget all allocations; keeps the memory, merged into one block */
+    void reset() {
+        if (count > 1) {
+            size_t total = mapped;
+            unmapAll();
+            grow(total);
+        }
+        used = 0;
+    }
+
+    // bytes mapped
+    size_t getCapacity() const {
+        return mapped;
+    }
+
+    // blocks mapped since construction; constant over runs that fit
+    int getMappings() const {
+        return mappings;
+    }
+
+private:
+    // map a block of at least bytes and allocate from it
+    void grow(size_t bytes) {
+        if (count == MAXBLOCKS) {
+            fprintf(stderr, "Arena: out of blocks\n");
+            exit(1);
+        }
+        size_t page = bytes < HUGEPAGE ? PAGE : HUGEPAGE;
+        size_t size = (bytes + page - 1) / page * page;
+        if (size == 0) size = PAGE;
+        char* base = map(size);
+        if (base == NULL) {
+            fprintf(stderr, "Arena: can't map %zu bytes\n", size);
+            exit(1);
+        }
+        blocks[count].base = base;
+        blocks[count].size = size;
+        count++;
+        used = 0;
+        mapped += size;
+        mappings++;
+    }
+
+    void unmapAll() {
+        for (int b = 0; b < count; b++) {
+            unmap(blocks[b].base, blocks[b].size);
+        }
+        count = 0;
+        used = 0;
+        mapped = 0;
+    }
+
+    // size bytes, aligned to HUGEPAGE from that size on, NULL on failure
+    static char* map(size_t size) {
+#ifdef __linux__
+        if (size < HUGEPAGE) {
+            void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            return p == MAP_FAILED ? NULL : (char*) p;
+        }
+        // map one huge page more and cut off the unaligned ends
+        size_t length = size + HUGEPAGE;
+        void* p = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return NULL;
+        uintptr_t start = (uintptr_t) p;
+        uintptr_t base = (start + HUGEPAGE - 1) & ~(uintptr_t) (HUGEPAGE - 1);
+        if (base > start) munmap(p, base - start);
+        if (base + size < start + length) munmap((void*) (base + size), start + length - (base + size));
+        madvise((void*) base, size, MADV_HUGEPAGE);
+        return (char*) base;
+#else
+        return (char*) aligned_alloc(size < HUGEPAGE ? PAGE : HUGEPAGE, size);
+#endif
+    }
+
+    static void unmap(char* base, size_t size) {
+#ifdef __linux__
+        munmap(base, size);
+#else
+        free(base);
+#endif
+    }
+};
@@ -0,0 +1,243 @@
+/*----------------------------------------------------------------
+ *
+ *  Written:       17/10/2026
+ *  Last updated:  17/10/2026
+ *
+ *
+ *  Moves the output of a Simulator onto its own thread. Use as
+ *  follows:
+ *
+ *  BinaryTrajectoryWriter writer("trajectory.bin", ...);
+ *  AsyncWriter<BinaryTrajectoryWriter> async(writer, 65536);
+ *  simulator.runSimulation(async);
+ *  async.close();
+ *  writer.close();
+ *
+ *  The simulation thread copies every state into a block and hands
+ *  full blocks to the writer thread through a bounded single-producer
+ *  single-consumer queue. The writer thread passes the states on to
+ *  sink.record and returns the block through a second queue, so the
+ *  blocks are allocated once and then recycled. With depth blocks
+ *  (2 by default: one being filled, one being written) the simulation
+ *  only waits when the disk is slower than the stepping. Such waits
+ *  show up as "writer backpressure" regions in the Timer report and
+ *  trace, the writing as "write block" on the writer thread.
+ *
+ *  A thread that finds its queue full or empty sleeps on a condition
+ *  variable until the other one pushes or pops; while neither has to
+ *  wait, the threads only touch the lock-free queues. close() ends
+ *  the writer thread by queueing a NULL block after the last one.
+ *
+ *----------------------------------------------------------------*/
+
+#pragma once
+
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Trajectory.h"
+#include "Timer.h"
+
+// Bounded lock-free queue for one producer and one consumer thread,
+// which can sleep until there is room or something to pop
+template <class T>
+class SpscQueue {
+
+private:
+    std::vector<T> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head;   // next slot to pop, written by the consumer
+    alignas(64) std::atomic<size_t> tail;   // next slot to push, written by the producer
+
+    // a thread sleeps on changed after raising its flag
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::atomic<bool> pushing;              // producer waits for room
+    std::atomic<bool> popping;              // consumer waits for an element
+
+public:
+    // room for at least capacity elements
+    SpscQueue(size_t capacity) : head(0), tail(0), pushing(false), popping(false) {
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        slots.resize(n);
+        mask = n - 1;
+    }
+
+    /* false if full */
+    bool push(const T &value) {
+        if (!tryPush(value)) return false;
+        wake(popping);
+        return true;
+    }
+
+    /* false if empty */
+    bool pop(T &value) {
+        if (!tryPop(value)) return false;
+        wake(pushing);
+        return true;
+    }
+
+    /* push, sleeping while full */
+    void waitPush(const T &value) {
+        std::unique_lock<std::mutex> lock(mutex);
+        sleep(pushing);
+        while (!tryPush(value)) {
+            changed.wait(lock);
+        }
+        pushing.store(false, std::memory_order_relaxed);
+        lock.unlock();
+        wake(popping);
+    }
+
+    /* pop, sleeping while empty */
+    void waitPop(T &value) {
+        std::unique_lock<std::mutex> lock(mutex);
+        sleep(popping);
+        while (!tryPop(value)) {
+            changed.wait(lock);
+        }
+        popping.store(false, std::memory_order_relaxed);
+        lock.unlock();
+        wake(pushing);
+    }
+
+private:
+    bool tryPush(const T &value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) > mask) return false;
+        slots[t & mask] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T &value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        value = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // raise the flag of a sleeper before it looks at the queue again;
+    // with the fence in wake() either it sees the other thread's change
+    // or that thread sees the flag
+    void sleep(std::atomic<bool> &flag) {
+        flag.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    // after a push or pop: wake the other thread if its flag is up
+    void wake(std::atomic<bool> &flag) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (flag.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            changed.notify_all();
+        }
+    }
+};
+
+template <class Sink>
+class AsyncWriter {
+
+private:
+    // consecutive states starting at step first
+    struct Block {
+        int first;
+        int count;
+        SimulatorState* rows;
+    };
+
+    Sink &sink;
+    int size;                   // states per block
+    std::vector<Block> blocks;  // owned storage, recycled through the queues
+    SpscQueue<Block*> full;     // simulation thread -> writer thread
+    SpscQueue<Block*> empty;    // writer thread -> simulation thread
+    Block* current;             // block being filled, NULL if none
+    std::thread writer;
+
+    AsyncWriter(const AsyncWriter&);
+    AsyncWriter& operator=(const AsyncWriter&);
+
+public:
+    AsyncWriter(Sink &sink, int size, int depth = 2)
+        : sink(sink), full(depth > 2 ? depth : 2), empty(depth > 2 ? depth : 2) {
+        this->size = size > 0 ? size : 1;
+        blocks.resize(depth > 2 ? depth : 2);
+        for (size_t b = 0; b < blocks.size(); b++) {
+            blocks[b].rows = new SimulatorState[this->size];
+            blocks[b].count = 0;
+            empty.push(&blocks[b]);
+        }
+        current = NULL;
+        writer = std::thread(&AsyncWriter::work, this);
+    }
+
+    ~AsyncWriter() {
+        close();
+        for (size_t b = 0; b < blocks.size(); b++) {
+            delete[] blocks[b].rows;
+        }
+    }
+
+    void record(int i, const SimulatorState &s) {
+        if (current == NULL) {
+            acquire();
+            current->first = i;
+            current->count = 0;
+        }
+        current->rows[current->count++] = s;
+        if (current->count == size) {
+            submit();
+        }
+    }
+
+    /* hand over the last partial block and wait until the sink has seen everything */
+    void close() {
+        if (!writer.joinable()) return;
+        if (current != NULL) {
+            submit();
+        }
+        full.waitPush(NULL);
+        writer.join();
+    }
+
+private:
+    void acquire() {
+        if (!empty.pop(current)) {
+            TimerRegion region("writer backpressure");
+            empty.waitPop(current);
+        }
+    }
+
+    void submit() {
+        if (!full.push(current)) {
+            TimerRegion region("writer backpressure");
+            full.waitPush(current);
+        }
+        current = NULL;
+    }
+
+    /* writer thread: pass blocks on to the sink until the NULL block of close() */
+    void work() {
+        Block* block;
+        for (;;) {
+            if (!full.pop(block)) {
+                full.waitPop(block);
+            }
+            if (block == NULL) return;
+            write(block);
+        }
+    }
+
+    void write(Block* block) {
+        TimerRegion region("write block");
+        for (int k = 0; k < block->count; k++) {
+            sink.record(block->first + k, block->rows[k]);
+        }
+        empty.push(block);
+    }
+};
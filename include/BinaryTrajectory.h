@@ -0,0 +1,345 @@
+/*----------------------------------------------------------------
+ *
+ *  Written:       17/10/2026
+ *  Last updated:  17/10/2026
+ *
+ *
+ *  Compact binary trajectory files. Use as follows:
+ *
+ *  BinaryTrajectoryWriter writer("trajectory.bin", steps, chunk,
+ *                                simulator.getParameters(), "philox");
+ *  simulator.runSimulation(writer);
+ *  writer.close();
+ *
+ *  BinaryTrajectory trajectory("trajectory.bin");
+ *  const double* lambda = trajectory.getColumn("lambda");
+ *  for (uint64_t i = 0; i < trajectory.getCount(); i++) ...
+ *
+ *  Layout: a header of HEADER_SIZE bytes (magic, version, byte order,
+ *  row count, seed, run, generator, parameters and column names)
+ *  followed by one column of raw little-endian doubles per variable.
+ *  Column j starts at HEADER_SIZE + 8 * j * capacity, so the reader
+ *  maps the file and hands out pointers into it without copying.
+ *
+ *  The writer reserves capacity = steps rows per column (the file is
+ *  extended to its full length when opened, sparse where nothing is
+ *  written yet) and writes every full chunk into place with pwrite,
+ *  then updates the row count in the header. If the run dies, the
+ *  file is still readable up to the last completed chunk; the reader
+ *  only needs the file to reach the last valid row of the last
+ *  column. close() packs the columns when the run stopped early, so
+ *  no space is left unused: it copies them into a new file NAME.pack
+ *  and renames that over NAME, so NAME holds either the unpacked or
+ *  the packed trajectory at every moment. A run killed while packing
+ *  leaves NAME readable and NAME.pack behind.
+ *
+ *----------------------------------------------------------------*/
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string>
+#include "Trajectory.h"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "BinaryTrajectory writes the host byte order and expects little endian"
+#endif
+
+// Fixed header at the start of every file, zero padded to HEADER_SIZE
+struct BinaryTrajectoryHeader {
+    static const int HEADER_SIZE = 4096;   // one page, keeps columns page aligned
+    static const int MAX_COLUMNS = 32;
+    static const uint32_t VERSION = 1;
+    static const uint32_t BYTEORDER = 0x01020304;
+
+    char magic[8];              // "LAMBDATR"
+    uint32_t version;           // VERSION
+    uint32_t byteorder;         // BYTEORDER as written by the host
+    uint64_t capacity;          // rows reserved per column
+    uint64_t count;             // rows written
+    uint32_t columns;           // number of columns
+    int32_t seed;               // seed and realization of the stream
+    int32_t run;
+    uint32_t reserved;
+    char rng[16];               // name of the uniform generator
+    double a0;                  // parameters, see SimulatorParameters
+    double tau0;
+    double deltatau;
+    double V0;
+    double rhomat0;
+    double rhorad0;
+    double lambda0;
+    double ell;
+    char names[MAX_COLUMNS][16]; // column names
+};
+
+// Streams the steps of a Simulator into a binary trajectory file
+class BinaryTrajectoryWriter {
+
+private:
+    static const int COLUMNS = 9;
+
+    int fd;
+    std::string filename;
+    BinaryTrajectoryHeader header;
+    double* chunk[COLUMNS];     // one buffer per column
+    int size;                   // capacity of each buffer
+    int count;                  // rows waiting in the buffers
+
+    BinaryTrajectoryWriter(const BinaryTrajectoryWriter&);
+    BinaryTrajectoryWriter& operator=(const BinaryTrajectoryWriter&);
+
+public:
+    BinaryTrajectoryWriter(const char* outputFilename, int steps, int size,
+                           const SimulatorParameters &p, const char* rng) {
+        fd = open(outputFilename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        filename = outputFilename;
+
+        if (fd < 0) {
+          fprintf(stderr, "Can't open output file %s!\n",
+                  outputFilename);
+          exit(1);
+        }
+
+        static const char* names[COLUMNS] = {
+            "tau", "lambda", "a", "N", "V", "S", "rhomat", "rhorad", "eta"
+        };
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "LAMBDATR", 8);
+        header.version = BinaryTrajectoryHeader::VERSION;
+        header.byteorder = BinaryTrajectoryHeader::BYTEORDER;
+        header.capacity = steps > 0 ? steps : 0;
+        header.count = 0;
+        header.columns = COLUMNS;
+        header.seed = p.seed;
+        header.run = p.run;
+        strncpy(header.rng, rng, sizeof(header.rng) - 1);
+        header.a0 = p.a0;
+        header.tau0 = p.tau0;
+        header.deltatau = p.deltatau;
+        header.V0 = p.V0;
+        header.rhomat0 = p.rhomat0;
+        header.rhorad0 = p.rhorad0;
+        header.lambda0 = p.lambda0;
+        header.ell = p.ell;
+        for (int j = 0; j < COLUMNS; j++) {
+            strncpy(header.names[j], names[j], sizeof(header.names[j]) - 1);
+        }
+
+        this->size = size > 0 ? size : 1;
+        this->count = 0;
+        for (int j = 0; j < COLUMNS; j++) {
+            chunk[j] = new double[this->size];
+        }
+        writeHeader(fd);
+        if (ftruncate(fd, offset(COLUMNS, header.capacity)) != 0) {
+            fprintf(stderr, "Can't extend binary trajectory!\n");
+            exit(1);
+        }
+    }
+
+    ~BinaryTrajectoryWriter() {
+        close();
+        for (int j = 0; j < COLUMNS; j++) {
+            delete[] chunk[j];
+        }
+    }
+
+    void record(int i, const SimulatorState &s) {
+        chunk[0][count] = s.tau;
+        chunk[1][count] = s.lambda;
+        chunk[2][count] = s.a;
+        chunk[3][count] = s.N;
+        chunk[4][count] = s.V;
+        chunk[5][count] = s.S;
+        chunk[6][count] = s.rhomat;
+        chunk[7][count] = s.rhorad;
+        chunk[8][count] = s.eta;
+        count++;
+        if (count == size) {
+            flush();
+        }
+    }
+
+    /* write the rows held so far into their columns and update the header */
+    void flush() {
+        if (fd < 0 || count == 0) return;
+        if (header.count + count > header.capacity) {
+            fprintf(stderr, "Binary trajectory holds only %llu steps!\n",
+                    (unsigned long long) header.capacity);
+            exit(1);
+        }
+        for (int j = 0; j < COLUMNS; j++) {
+            write(fd, chunk[j], count * sizeof(double), offset(j, header.capacity) + header.count * sizeof(double));
+        }
+        header.count += count;
+        count = 0;
+        writeHeader(fd);
+    }
+
+    /* write the last partial chunk, pack the columns and close the file */
+    void close() {
+        if (fd < 0) return;
+        flush();
+        if (header.count < header.capacity) {
+            pack();
+        }
+        ::close(fd);
+        fd = -1;
+    }
+
+private:
+    static uint64_t offset(int column, uint64_t capacity) {
+        return BinaryTrajectoryHeader::HEADER_SIZE + column * capacity * sizeof(double);
+    }
+
+    static void write(int to, const void* data, size_t bytes, uint64_t position) {
+        const char* p = (const char*) data;
+        while (bytes > 0) {
+            ssize_t n = pwrite(to, p, bytes, position);
+            if (n <= 0) {
+                fprintf(stderr, "Can't write binary trajectory!\n");
+                exit(1);
+            }
+            p += n;
+            bytes -= n;
+            position += n;
+        }
+    }
+
+    void writeHeader(int to) {
+        char page[BinaryTrajectoryHeader::HEADER_SIZE];
+        memset(page, 0, sizeof(page));
+        memcpy(page, &header, sizeof(header));
+        write(to, page, sizeof(page), 0);
+    }
+
+    /* replace the file by a copy with capacity == count */
+    void pack() {
+        std::string packedFilename = filename + ".pack";
+        int packed = open(packedFilename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+        if (packed < 0) {
+          fprintf(stderr, "Can't open output file %s!\n",
+                  packedFilename.c_str());
+          exit(1);
+        }
+
+        uint64_t rows = header.count;
+        for (int j = 0; j < COLUMNS; j++) {
+            for (uint64_t done = 0; done < rows; done += size) {
+                uint64_t n = rows - done < (uint64_t) size ? rows - done : size;
+                uint64_t from = offset(j, header.capacity) + done * sizeof(double);
+                if (pread(fd, chunk[0], n * sizeof(double), from) != (ssize_t) (n * sizeof(double))) {
+                    fprintf(stderr, "Can't read binary trajectory!\n");
+                    exit(1);
+                }
+                write(packed, chunk[0], n * sizeof(double), offset(j, rows) + done * sizeof(double));
+            }
+        }
+        header.capacity = rows;
+        writeHeader(packed);
+        // the copy must be on disk before it replaces the original
+        if (fsync(packed) != 0 || rename(packedFilename.c_str(), filename.c_str()) != 0) {
+            fprintf(stderr, "Can't replace %s by its packed copy!\n", filename.c_str());
+            exit(1);
+        }
+        ::close(fd);
+        fd = packed;
+    }
+};
+
+// Read-only view of a binary trajectory file, mapped into memory
+class BinaryTrajectory {
+
+private:
+    void* data;
+    size_t length;
+    const BinaryTrajectoryHeader* header;
+
+    BinaryTrajectory(const BinaryTrajectory&);
+    BinaryTrajectory& operator=(const BinaryTrajectory&);
+
+public:
+    BinaryTrajectory(const char* inputFilename) {
+        int fd = open(inputFilename, O_RDONLY);
+        struct stat st;
+
+        if (fd < 0 || fstat(fd, &st) != 0) {
+          fprintf(stderr, "Can't open input file %s!\n",
+                  inputFilename);
+          exit(1);
+        }
+
+        length = st.st_size;
+        if (length < (size_t) BinaryTrajectoryHeader::HEADER_SIZE) {
+            fprintf(stderr, "%s is not a binary trajectory!\n", inputFilename);
+            exit(1);
+        }
+        data = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            fprintf(stderr, "Can't map input file %s!\n", inputFilename);
+            exit(1);
+        }
+
+        header = (const BinaryTrajectoryHeader*) data;
+        if (memcmp(header->magic, "LAMBDATR", 8) != 0 ||
+            header->version != BinaryTrajectoryHeader::VERSION ||
+            header->byteorder != BinaryTrajectoryHeader::BYTEORDER ||
+            header->columns > (uint32_t) BinaryTrajectoryHeader::MAX_COLUMNS ||
+            end() > length) {
+            fprintf(stderr, "%s is not a binary trajectory!\n", inputFilename);
+            exit(1);
+        }
+    }
+
+    ~BinaryTrajectory() {
+        munmap(data, length);
+    }
+
+    // bytes up to the last valid row of the last column
+    uint64_t end() const {
+        if (header->columns == 0) return BinaryTrajectoryHeader::HEADER_SIZE;
+        return BinaryTrajectoryHeader::HEADER_SIZE + ((header->columns - 1) * header->capacity + getCount()) * sizeof(double);
+    }
+
+    const BinaryTrajectoryHeader& getHeader() const {
+        return *header;
+    }
+
+    /* number of valid rows */
+    uint64_t getCount() const {
+        return header->count < header->capacity ? header->count : header->capacity;
+    }
+
+    int getColumns() const {
+        return header->columns;
+    }
+
+    const char* getName(int column) const {
+        return header->names[column];
+    }
+
+    /* column by index or name, NULL if there is no such column */
+    const double* getColumn(int column) const {
+        if (column < 0 || column >= (int) header->columns) return NULL;
+        return (const double*) ((const char*) data + BinaryTrajectoryHeader::HEADER_SIZE) + column * header->capacity;
+    }
+
+    const double* getColumn(const char* name) const {
+        for (int j = 0; j < (int) header->columns; j++) {
+            if (strncmp(header->names[j], name, sizeof(header->names[j])) == 0) {
+                return getColumn(j);
+            }
+        }
+        return NULL;
+    }
+};
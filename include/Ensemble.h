@@ -0,0 +1,245 @@
+/*----------------------------------------------------------------
+ *
+ *  Written:       17/10/2026
+ *  Last updated:  17/10/2026
+ *
+ *
+ *  Runs many independent realizations of the Simulator on a pool
+ *  of threads. Use as follows:
+ *
+ *  Ensemble<CRandomPhilox> ensemble(steps, realizations, threads, seed);
+ *  ensemble.run();
+ *  ensemble.printToFile("lambda-ensemble.txt");
+ *
+ *  Realization r draws from its own stream (seed, r) of generator RNG.
+ *  The realizations are cut into blocks of BLOCK, which the workers
+ *  take in turn. A block is folded, in the order of its realizations,
+ *  into an EnsembleReducer of its own, which is the Simulator's sink,
+ *  so no realization stores its trajectory; the last step each
+ *  realization reaches goes into a Statistics next to it. Finished
+ *  blocks are merged into the total in block order, as soon as all
+ *  blocks before them are, and their accumulators are reused. So
+ *  every sum and every quantile sketch sees the same data in the same
+ *  order whatever the number of threads and the schedule, and the
+ *  result is bit for bit the same.
+ *
+ *  With lanes = 4 or 8 every worker runs its realizations in the lanes
+ *  of a LaneSimulator instead, 4 or 8 per vector instruction. lanes = 1
+ *  (the default) runs one Simulator at a time.
+ *
+ *  All realizations share the initial conditions and model parameters
+ *  p (default: defaultParameters()); p.seed and p.run are ignored.
+ *
+ *----------------------------------------------------------------*/
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Simulator.h"
+#include "LaneSimulator.h"
+#include "Statistics.h"
+#include "EnsembleReducer.h"
+
+template <class RNG>
+class Ensemble {
+
+public:
+    // realizations per block
+    static const int BLOCK = 64;
+
+private:
+    /* everything collected from one block */
+    struct Accumulator {
+        EnsembleReducer lambda;
+        Statistics laststep;
+
+        Accumulator(int steps, int quantilesteps) : lambda(steps, quantilesteps) {
+        }
+
+        void clear() {
+            lambda.clear();
+            laststep.clear();
+        }
+    };
+
+    int steps;
+    int realizations;
+    int threads;
+    int seed;
+    int quantilesteps;
+    int lanes;
+    SimulatorParameters params;
+
+    /* next block to be handed out */
+    std::atomic<int> next;
+
+    /* merged statistics of blocks 0 .. merged - 1 */
+    Accumulator total;
+    int merged;
+
+    /* finished blocks waiting for those before them, and accumulators
+     * to reuse; guarded by lock */
+    std::mutex lock;
+    std::map<int, Accumulator*> pending;
+    std::vector<Accumulator*> spare;
+    std::vector<Accumulator*> owned;
+
+public:
+    // quantilesteps: number of steps for which quantiles of lambda are kept;
+    // lanes: realizations per vector instruction (1, 4 or 8);
+    // p: initial conditions and model parameters of every realization
+    Ensemble(int steps, int realizations, int threads, int seed, int quantilesteps = 100, int lanes = 1,
+             const SimulatorParameters &p = defaultParameters())
+        : params(p), total(steps, quantilesteps) {
+        this->steps = steps;
+        this->realizations = realizations;
+        this->threads = threads > 0 ? threads : 1;
+        this->seed = seed;
+        this->quantilesteps = quantilesteps;
+        this->lanes = lanes;
+        this->next = 0;
+        this->merged = 0;
+    }
+
+    ~Ensemble() {
+        for (size_t k = 0; k < owned.size(); k++) {
+            delete owned[k];
+        }
+    }
+
+    /* run all realizations and reduce their lambda statistics */
+    void run() {
+        TimerRegion region("ensemble");
+        std::vector<std::thread> pool;
+        next = 0;
+        merged = 0;
+        total.clear();
+        for (int t = 0; t < threads; t++) {
+            pool.push_back(std::thread(&Ensemble::work, this));
+        }
+        for (int t = 0; t < threads; t++) {
+            pool[t].join();
+        }
+    }
+
+    /* per-step statistics of lambda */
+    EnsembleReducer& getReducer() {
+        return total.lambda;
+    }
+
+    double getMean(int i) const {
+        return total.lambda.getMean(i);
+    }
+
+    double getSdev(int i) const {
+        return total.lambda.getSdev(i);
+    }
+
+    /* last step reached by the realizations (steps - 1 unless the root became negative) */
+    Statistics& getLastStep() {
+        return total.laststep;
+    }
+
+    /* write tau, mean and standard deviation of lambda and the sample size per step */
+    void printToFile(const char* outputFilename) {
+        total.lambda.printToFile(outputFilename);
+    }
+
+private:
+    /* hands the realizations of a block to a LaneSimulator and collects their steps */
+    struct Jobs {
+        int run;        // next realization
+        int end;        // first realization after the block
+        Accumulator* acc;
+
+        int next() {
+            return run < end ? run++ : -1;
+        }
+
+        void record(int i, const SimulatorState &s) {
+            acc->lambda.record(i, s);
+        }
+
+        void finish(int run, int laststep) {
+            acc->laststep.push(laststep);
+        }
+    };
+
+    /* worker loop: pull blocks until none are left */
+    void work() {
+        if (lanes == 8) {
+            LaneSimulator<RNG, 8> lanesimulator(steps, seed, params);
+            workBlocks(&lanesimulator);
+        } else if (lanes == 4) {
+            LaneSimulator<RNG, 4> lanesimulator(steps, seed, params);
+            workBlocks(&lanesimulator);
+        } else {
+            workBlocks<LaneSimulator<RNG, 4> >(NULL);
+        }
+    }
+
+    // lanesimulator: runs the blocks, NULL for one Simulator at a time
+    template <class Lanes>
+    void workBlocks(Lanes* lanesimulator) {
+        int blocks = (realizations + BLOCK - 1) / BLOCK;
+        for (int b = next++; b < blocks; b = next++) {
+            Accumulator* acc = take();
+            int first = b * BLOCK;
+            int end = first + BLOCK < realizations ? first + BLOCK : realizations;
+            if (lanesimulator != NULL) {
+                Jobs jobs = { first, end, acc };
+                lanesimulator->run(jobs);
+            } else {
+                SimulatorParameters p = params;
+                p.seed = seed;
+                for (int r = first; r < end; r++) {
+                    TimerRegion region("realization");
+                    p.run = r;
+                    Simulator<RNG> simulator(steps, p, false);
+                    simulator.runSimulation(acc->lambda);
+                    acc->laststep.push(simulator.getLastStep());
+                }
+            }
+            finish(b, acc);
+        }
+    }
+
+    // a cleared accumulator for the next block
+    Accumulator* take() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (!spare.empty()) {
+                Accumulator* acc = spare.back();
+                spare.pop_back();
+                acc->clear();
+                return acc;
+            }
+        }
+        Accumulator* acc = new Accumulator(steps, quantilesteps);
+        std::lock_guard<std::mutex> guard(lock);
+        owned.push_back(acc);
+        return acc;
+    }
+
+    // block b is done: merge it and every waiting block after it in order
+    void finish(int b, Accumulator* acc) {
+        std::lock_guard<std::mutex> guard(lock);
+        pending[b] = acc;
+        while (!pending.empty() && pending.begin()->first == merged) {
+            TimerRegion region("merge");
+            Accumulator* done = pending.begin()->second;
+            total.lambda.merge(done->lambda);
+            total.laststep.merge(done->laststep);
+            pending.erase(pending.begin());
+            spare.push_back(done);
+            merged++;
+        }
+    }
+};
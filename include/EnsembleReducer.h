@@ -0,0 +1,172 @@
+/*----------------------------------------------------------------
+ *
+ *  Written:       17/10/2026
+ *  Last updated:  17/10/2026
+ *
+ *
+ *  Per-step statistics of lambda over the realizations of an
+ *  ensemble. Use as follows:
+ *
+ *  EnsembleReducer reducer(steps, 100);
+ *  for each realization: simulator.runSimulation(reducer);
+ *  reducer.printToFile("lambda-ensemble.txt");
+ *
+ *  The reducer is a Simulator sink, so every run is folded in step by
+ *  step and nothing per run is stored or written. It keeps the Moments
+ *  of Statistics (count, mean, M2 = sum (x - mean)^2, ...) for every
+ *  step, and merge() adds another reducer with their merge formula,
+ *  so every block of realizations fills its own reducer without
+ *  locking. The standard deviation of a step fewer than two
+ *  realizations reach is 0.
+ *
+ *  Quantiles need a QuantileSketch per step, which is too much memory
+ *  for every step, so they are kept for quantilesteps steps evenly
+ *  spread over the run (every step if there are fewer).
+ *
+ *----------------------------------------------------------------*/
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include "Trajectory.h"
+#include "QuantileSketch.h"
+#include "Statistics.h"
+
+class EnsembleReducer {
+
+private:
+    static constexpr double COMPRESSION = 100.0;   // of each per-step sketch
+
+    int steps;
+
+    /* per-step moments of lambda, and tau */
+    std::vector<Moments> moments;
+    std::vector<double> tau;
+
+    /* sketches[j] holds lambda at step j * stride */
+    int stride;
+    std::vector<QuantileSketch> sketches;
+
+public:
+    EnsembleReducer(int steps, int quantilesteps) {
+        this->steps = steps;
+        moments.resize(steps);
+        clear();
+        if (quantilesteps > 0 && steps > 0) {
+            stride = (steps + quantilesteps - 1) / quantilesteps;
+            sketches.assign((steps + stride - 1) / stride, QuantileSketch(COMPRESSION));
+        } else {
+            stride = 0;
+        }
+    }
+
+    /* forget all realizations */
+    void clear() {
+        for (int i = 0; i < steps; i++) {
+            moments[i].clear();
+        }
+        tau.assign(steps, 0.0);
+        for (size_t j = 0; j < sketches.size(); j++) {
+            sketches[j].clear();
+        }
+    }
+
+    void record(int i, const SimulatorState &s) {
+        double x = s.lambda;
+        moments[i].push(x);
+        tau[i] = s.tau;
+        if (stride > 0 && i % stride == 0) {
+            sketches[i / stride].push(x);
+        }
+    }
+
+    /* add the realizations folded into other, which has the same steps */
+    void merge(const EnsembleReducer &other) {
+        for (int i = 0; i < steps; i++) {
+            if (other.moments[i].n == 0) continue;
+            moments[i].merge(other.moments[i]);
+            tau[i] = other.tau[i];
+        }
+        for (size_t j = 0; j < sketches.size(); j++) {
+            sketches[j].merge(other.sketches[j]);
+        }
+    }
+
+    int getSteps() const {
+        return steps;
+    }
+
+    long long getCount(int i) const {
+        return moments[i].n;
+    }
+
+    double getTau(int i) const {
+        return tau[i];
+    }
+
+    double getMean(int i) const {
+        return moments[i].mean;
+    }
+
+    double getSdev(int i) const {
+        return sqrt(moments[i].getVariance());
+    }
+
+    /* true if quantiles are kept for step i */
+    bool hasQuantiles(int i) const {
+        return stride > 0 && i % stride == 0;
+    }
+
+    /* q-quantile of lambda at step i, NAN if not kept */
+    double getQuantile(int i, double q) {
+        if (!hasQuantiles(i)) return NAN;
+        return sketches[i / stride].getQuantile(q);
+    }
+
+    /* write tau, mean and standard deviation of lambda and the sample size per step */
+    void printToFile(const char* outputFilename) {
+        FILE *ofp = fopen(outputFilename, "w");
+
+        if (ofp == NULL) {
+          fprintf(stderr, "Can't open output file %s!\n",
+                  outputFilename);
+          exit(1);
+        }
+
+        for (int i = 0; i < steps; i++) {
+            if (moments[i].n == 0) break;
+            fprintf(ofp, "%E\t%E\t%E\t%lld\n", tau[i], getMean(i), getSdev(i), moments[i].n);
+        }
+        fclose(ofp);
+    }
+
+    /* write tau and the quantiles qs[0..nq-1] of lambda for every step that keeps them */
+    void printQuantilesToFile(const char* outputFilename, const double* qs, int nq) {
+        FILE *ofp = fopen(outputFilename, "w");
+
+        if (ofp == NULL) {
+          fprintf(stderr, "Can't open output file %s!\n",
+                  outputFilename);
+          exit(1);
+        }
+
+        fprintf(ofp, "# tau");
+        for (int k = 0; k < nq; k++) {
+            fprintf(ofp, "\tq%g", qs[k]);
+        }
+        fprintf(ofp, "\n");
+        for (int i = 0; i < steps; i++) {
+            if (moments[i].n == 0) break;
+            if (!hasQuantiles(i)) continue;
+            fprintf(ofp, "%E", tau[i]);
+            for (int k = 0; k < nq; k++) {
+                fprintf(ofp, "\t%E", getQuantile(i, qs[k]));
+            }
+            fprintf(ofp, "\n");
+        }
+        fclose(ofp);
+    }
+};
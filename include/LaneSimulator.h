@@ -0,0 +1,454 @@
+/*----------------------------------------------------------------
+ *
+ *  Written:       17/10/2026
+ *  Last updated:  17/10/2026
+ *
+ *
+ *  Runs W realizations of the Simulator side by side, one per lane
+ *  of a vector register. Use as follows:
+ *
+ *  LaneSimulator<CRandomPhilox, 4> lanes(steps, seed, simulator.getParameters());
+ *  lanes.run(jobs);
+ *
+ *  where jobs has the methods
+ *
+ *  int next();                                 // next realization, -1 if none
+ *  void record(int i, const SimulatorState &s);
+ *  void finish(int run, int laststep);
+ *
+ *  The arithmetic of Simulator::doStep is the same for every
+ *  realization, only the gaussian noise differs. The state of the W
+ *  lanes is kept as one array per quantity (SoA), so a step of all
+ *  lanes is one pass of vector instructions: AVX2 for W = 4 and
+ *  AVX-512 for W = 8, selected at run time if the CPU has them, a
+ *  plain loop over the lanes otherwise. Each lane draws its noise from
+ *  its own stream (seed, run) as the Simulator does.
+ *
+ *  The step returns a mask of the lanes whose root became negative.
+ *  Such a lane records its last step and stops, like runSimulation,
+ *  and immediately starts the next realization from jobs, so lanes
+ *  do not idle while others run to the end. Idle lanes (no
+ *  realizations left) keep stepping from the initial state and are
+ *  not recorded.
+ *
+ *  The only difference to doStep is that (a0 / a)^3 and (a0 / a)^4
+ *  are products instead of calls to pow, so the lanes agree with the
+ *  Simulator to rounding but not bit for bit. All kernels give
+ *  identical results.
+ *
+ *----------------------------------------------------------------*/
+
+#pragma once
+
+#include <math.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include "Simulator.h"
+
+// Constants of the recurrence, shared by all lanes
+struct LaneConstants {
+    double tau0;
+    double deltatau;
+    double a0;
+    double rhomat0;
+    double rhorad0;
+    double cm2;         // c^-2
+    double cvolume;     // c^4 4 pi / 3
+    double clambda;     // c kappa
+};
+
+// State of W lanes, one array per quantity
+template <int W>
+struct LaneState {
+    alignas(64) double step[W];     // index of the current step
+    alignas(64) double tau[W];
+    alignas(64) double a[W];
+    alignas(64) double N[W];
+    alignas(64) double V[W];
+    alignas(64) double S[W];
+    alignas(64) double rhomat[W];
+    alignas(64) double rhorad[W];
+    alignas(64) double lambda[W];
+    alignas(64) double eta[W];
+    alignas(64) double m0[W];       // moments of VolumeEngine
+    alignas(64) double m1[W];
+    alignas(64) double m2[W];
+    alignas(64) double m3[W];
+    alignas(64) double ell4[W];     // ell^4, may differ between lanes
+};
+
+// Constants of the recurrence for parameters p
+inline LaneConstants laneConstants(const SimulatorParameters &p) {
+    LaneConstants c;
+    c.tau0 = p.tau0;
+    c.deltatau = p.deltatau;
+    c.a0 = p.a0;
+    c.rhomat0 = p.rhomat0;
+    c.rhorad0 = p.rhorad0;
+    c.cm2 = pow(CLIGHT, -2.0);
+    c.cvolume = pow(CLIGHT, 4.0) * 4.0 * PI / 3.0;
+    c.clambda = CLIGHT * KAPPA;
+    return c;
+}
+
+// Put lane l of s at step 0 of parameters p with free parameter ell
+template <int W>
+void laneReset(LaneState<W> &s, int l, const SimulatorParameters &p, double ell) {
+    s.ell4[l] = pow(ell, 4.0);
+    s.step[l] = 0.0;
+    s.tau[l] = p.tau0;
+    s.a[l] = p.a0;
+    s.N[l] = p.V0 / s.ell4[l];
+    s.V[l] = p.V0;
+    s.S[l] = 0.0;
+    s.rhomat[l] = p.rhomat0;
+    s.rhorad[l] = p.rhorad0;
+    s.lambda[l] = p.lambda0;
+    s.eta[l] = 0.0;
+    s.m0[l] = 0.0;
+    s.m1[l] = 0.0;
+    s.m2[l] = 0.0;
+    s.m3[l] = 0.0;
+}
+
+// One step of every lane with noise g; returns the lanes with root < 0 as bits
+template <int W>
+unsigned laneStep(LaneState<W> &s, const double* g, const LaneConstants &c) {
+    unsigned negative = 0;
+    for (int l = 0; l < W; l++) {
+        double root = (s.rhorad[l] + s.rhomat[l] + s.lambda[l] / KAPPA) * 8.0 * PI * GNEWTON * c.cm2 / 3.0;
+        s.step[l] += 1.0;
+        double tau = c.tau0 + s.step[l] * c.deltatau;
+        double dt = tau - s.tau[l];
+        double a = s.a[l];
+        s.tau[l] = tau;
+        s.a[l] = a * (1.0 + sqrt(root) * dt);
+
+        double d = dt / a;
+        double d2 = d * d;
+        s.m3[l] += 3.0 * d * s.m2[l] + 3.0 * d2 * s.m1[l] + d2 * d * s.m0[l];
+        s.m2[l] += 2.0 * d * s.m1[l] + d2 * s.m0[l];
+        s.m1[l] += d * s.m0[l];
+        double w = a * a * a * dt;
+        s.m0[l] += w;
+        s.m1[l] += w * d;
+        s.m2[l] += w * d2;
+        s.m3[l] += w * d2 * d;
+        s.eta[l] += d;
+
+        double V = c.cvolume * s.m3[l];
+        double N = V / s.ell4[l];
+        s.S[l] = s.S[l] + g[l] * sqrt(N - s.N[l]) * HBAR;
+        s.V[l] = V;
+        s.N[l] = N;
+        s.lambda[l] = c.clambda * s.S[l] / V;
+
+        double r = c.a0 / s.a[l];
+        double r2 = r * r;
+        s.rhomat[l] = c.rhomat0 * (r2 * r);
+        s.rhorad[l] = c.rhorad0 * (r2 * r2);
+        if (root < 0) negative |= 1u << l;
+    }
+    return negative;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// No fused multiply-add: every kernel rounds like the scalar loop
+#pragma GCC push_options
+#pragma GCC optimize ("fp-contract=off")
+
+// laneStep<4> on AVX2, operation for operation
+__attribute__((target("avx2")))
+inline unsigned laneStepAvx2(LaneState<4> &s, const double* g, const LaneConstants &c) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d two = _mm256_set1_pd(2.0);
+    const __m256d three = _mm256_set1_pd(3.0);
+    __m256d rhorad = _mm256_load_pd(s.rhorad);
+    __m256d rhomat = _mm256_load_pd(s.rhomat);
+    __m256d lambda = _mm256_load_pd(s.lambda);
+    __m256d root = _mm256_add_pd(_mm256_add_pd(rhorad, rhomat), _mm256_div_pd(lambda, _mm256_set1_pd(KAPPA)));
+    root = _mm256_mul_pd(root, _mm256_set1_pd(8.0));
+    root = _mm256_mul_pd(root, _mm256_set1_pd(PI));
+    root = _mm256_mul_pd(root, _mm256_set1_pd(GNEWTON));
+    root = _mm256_mul_pd(root, _mm256_set1_pd(c.cm2));
+    root = _mm256_div_pd(root, three);
+
+    __m256d step = _mm256_add_pd(_mm256_load_pd(s.step), one);
+    __m256d tau = _mm256_add_pd(_mm256_set1_pd(c.tau0), _mm256_mul_pd(step, _mm256_set1_pd(c.deltatau)));
+    __m256d dt = _mm256_sub_pd(tau, _mm256_load_pd(s.tau));
+    __m256d a = _mm256_load_pd(s.a);
+    __m256d anew = _mm256_mul_pd(a, _mm256_add_pd(one, _mm256_mul_pd(_mm256_sqrt_pd(root), dt)));
+
+    __m256d d = _mm256_div_pd(dt, a);
+    __m256d d2 = _mm256_mul_pd(d, d);
+    __m256d m0 = _mm256_load_pd(s.m0);
+    __m256d m1 = _mm256_load_pd(s.m1);
+    __m256d m2 = _mm256_load_pd(s.m2);
+    __m256d m3 = _mm256_load_pd(s.m3);
+    m3 = _mm256_add_pd(m3, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(three, d), m2),
+                                                       _mm256_mul_pd(_mm256_mul_pd(three, d2), m1)),
+                                         _mm256_mul_pd(_mm256_mul_pd(d2, d), m0)));
+    m2 = _mm256_add_pd(m2, _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(two, d), m1), _mm256_mul_pd(d2, m0)));
+    m1 = _mm256_add_pd(m1, _mm256_mul_pd(d, m0));
+    __m256d w = _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(a, a), a), dt);
+    m0 = _mm256_add_pd(m0, w);
+    m1 = _mm256_add_pd(m1, _mm256_mul_pd(w, d));
+    m2 = _mm256_add_pd(m2, _mm256_mul_pd(w, d2));
+    m3 = _mm256_add_pd(m3, _mm256_mul_pd(_mm256_mul_pd(w, d2), d));
+    __m256d eta = _mm256_add_pd(_mm256_load_pd(s.eta), d);
+
+    __m256d V = _mm256_mul_pd(_mm256_set1_pd(c.cvolume), m3);
+    __m256d N = _mm256_div_pd(V, _mm256_load_pd(s.ell4));
+    __m256d noise = _mm256_mul_pd(_mm256_loadu_pd(g), _mm256_sqrt_pd(_mm256_sub_pd(N, _mm256_load_pd(s.N))));
+    __m256d S = _mm256_add_pd(_mm256_load_pd(s.S), _mm256_mul_pd(noise, _mm256_set1_pd(HBAR)));
+    lambda = _mm256_div_pd(_mm256_mul_pd(_mm256_set1_pd(c.clambda), S), V);
+
+    __m256d r = _mm256_div_pd(_mm256_set1_pd(c.a0), anew);
+    __m256d r2 = _mm256_mul_pd(r, r);
+    rhomat = _mm256_mul_pd(_mm256_set1_pd(c.rhomat0), _mm256_mul_pd(r2, r));
+    rhorad = _mm256_mul_pd(_mm256_set1_pd(c.rhorad0), _mm256_mul_pd(r2, r2));
+
+    _mm256_store_pd(s.step, step);
+    _mm256_store_pd(s.tau, tau);
+    _mm256_store_pd(s.a, anew);
+    _mm256_store_pd(s.m0, m0);
+    _mm256_store_pd(s.m1, m1);
+    _mm256_store_pd(s.m2, m2);
+    _mm256_store_pd(s.m3, m3);
+    _mm256_store_pd(s.eta, eta);
+    _mm256_store_pd(s.V, V);
+    _mm256_store_pd(s.N, N);
+    _mm256_store_pd(s.S, S);
+    _mm256_store_pd(s.lambda, lambda);
+    _mm256_store_pd(s.rhomat, rhomat);
+    _mm256_store_pd(s.rhorad, rhorad);
+    return (unsigned) _mm256_movemask_pd(_mm256_cmp_pd(root, _mm256_setzero_pd(), _CMP_LT_OQ));
+}
+
+// laneStep<8> on AVX-512, operation for operation
+__attribute__((target("avx512f")))
+inline unsigned laneStepAvx512(LaneState<8> &s, const double* g, const LaneConstants &c) {
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d two = _mm512_set1_pd(2.0);
+    const __m512d three = _mm512_set1_pd(3.0);
+    __m512d rhorad = _mm512_load_pd(s.rhorad);
+    __m512d rhomat = _mm512_load_pd(s.rhomat);
+    __m512d lambda = _mm512_load_pd(s.lambda);
+    __m512d root = _mm512_add_pd(_mm512_add_pd(rhorad, rhomat), _mm512_div_pd(lambda, _mm512_set1_pd(KAPPA)));
+    root = _mm512_mul_pd(root, _mm512_set1_pd(8.0));
+    root = _mm512_mul_pd(root, _mm512_set1_pd(PI));
+    root = _mm512_mul_pd(root, _mm512_set1_pd(GNEWTON));
+    root = _mm512_mul_pd(root, _mm512_set1_pd(c.cm2));
+    root = _mm512_div_pd(root, three);
+
+    __m512d step = _mm512_add_pd(_mm512_load_pd(s.step), one);
+    __m512d tau = _mm512_add_pd(_mm512_set1_pd(c.tau0), _mm512_mul_pd(step, _mm512_set1_pd(c.deltatau)));
+    __m512d dt = _mm512_sub_pd(tau, _mm512_load_pd(s.tau));
+    __m512d a = _mm512_load_pd(s.a);
+    __m512d anew = _mm512_mul_pd(a, _mm512_add_pd(one, _mm512_mul_pd(_mm512_maskz_sqrt_pd(0xFF, root), dt)));
+
+    __m512d d = _mm512_div_pd(dt, a);
+    __m512d d2 = _mm512_mul_pd(d, d);
+    __m512d m0 = _mm512_load_pd(s.m0);
+    __m512d m1 = _mm512_load_pd(s.m1);
+    __m512d m2 = _mm512_load_pd(s.m2);
+    __m512d m3 = _mm512_load_pd(s.m3);
+    m3 = _mm512_add_pd(m3, _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(_mm512_mul_pd(three, d), m2),
+                                                       _mm512_mul_pd(_mm512_mul_pd(three, d2), m1)),
+                                         _mm512_mul_pd(_mm512_mul_pd(d2, d), m0)));
+    m2 = _mm512_add_pd(m2, _mm512_add_pd(_mm512_mul_pd(_mm512_mul_pd(two, d), m1), _mm512_mul_pd(d2, m0)));
+    m1 = _mm512_add_pd(m1, _mm512_mul_pd(d, m0));
+    __m512d w = _mm512_mul_pd(_mm512_mul_pd(_mm512_mul_pd(a, a), a), dt);
+    m0 = _mm512_add_pd(m0, w);
+    m1 = _mm512_add_pd(m1, _mm512_mul_pd(w, d));
+    m2 = _mm512_add_pd(m2, _mm512_mul_pd(w, d2));
+    m3 = _mm512_add_pd(m3, _mm512_mul_pd(_mm512_mul_pd(w, d2), d));
+    __m512d eta = _mm512_add_pd(_mm512_load_pd(s.eta), d);
+
+    __m512d V = _mm512_mul_pd(_mm512_set1_pd(c.cvolume), m3);
+    __m512d N = _mm512_div_pd(V, _mm512_load_pd(s.ell4));
+    __m512d noise = _mm512_mul_pd(_mm512_loadu_pd(g), _mm512_maskz_sqrt_pd(0xFF, _mm512_sub_pd(N, _mm512_load_pd(s.N))));
+    __m512d S = _mm512_add_pd(_mm512_load_pd(s.S), _mm512_mul_pd(noise, _mm512_set1_pd(HBAR)));
+    lambda = _mm512_div_pd(_mm512_mul_pd(_mm512_set1_pd(c.clambda), S), V);
+
+    __m512d r = _mm512_div_pd(_mm512_set1_pd(c.a0), anew);
+    __m512d r2 = _mm512_mul_pd(r, r);
+    rhomat = _mm512_mul_pd(_mm512_set1_pd(c.rhomat0), _mm512_mul_pd(r2, r));
+    rhorad = _mm512_mul_pd(_mm512_set1_pd(c.rhorad0), _mm512_mul_pd(r2, r2));
+
+    _mm512_store_pd(s.step, step);
+    _mm512_store_pd(s.tau, tau);
+    _mm512_store_pd(s.a, anew);
+    _mm512_store_pd(s.m0, m0);
+    _mm512_store_pd(s.m1, m1);
+    _mm512_store_pd(s.m2, m2);
+    _mm512_store_pd(s.m3, m3);
+    _mm512_store_pd(s.eta, eta);
+    _mm512_store_pd(s.V, V);
+    _mm512_store_pd(s.N, N);
+    _mm512_store_pd(s.S, S);
+    _mm512_store_pd(s.lambda, lambda);
+    _mm512_store_pd(s.rhomat, rhomat);
+    _mm512_store_pd(s.rhorad, rhorad);
+    return (unsigned) _mm512_cmp_pd_mask(root, _mm512_setzero_pd(), _CMP_LT_OQ);
+}
+
+#pragma GCC pop_options
+
+#endif
+
+// Fastest step for W lanes on this CPU, and the name of its instruction set
+template <int W>
+struct LaneKernel {
+    typedef unsigned (*Step)(LaneState<W>&, const double*, const LaneConstants&);
+    static Step select(const char* &name) {
+        name = "scalar";
+        return &laneStep<W>;
+    }
+};
+
+template <>
+struct LaneKernel<4> {
+    typedef unsigned (*Step)(LaneState<4>&, const double*, const LaneConstants&);
+    static Step select(const char* &name) {
+#if defined(__x86_64__) || defined(__i386__)
+        if (__builtin_cpu_supports("avx2")) {
+            name = "AVX2";
+            return &laneStepAvx2;
+        }
+#endif
+        name = "scalar";
+        return &laneStep<4>;
+    }
+};
+
+template <>
+struct LaneKernel<8> {
+    typedef unsigned (*Step)(LaneState<8>&, const double*, const LaneConstants&);
+    static Step select(const char* &name) {
+#if defined(__x86_64__) || defined(__i386__)
+        if (__builtin_cpu_supports("avx512f")) {
+            name = "AVX-512";
+            return &laneStepAvx512;
+        }
+#endif
+        name = "scalar";
+        return &laneStep<8>;
+    }
+};
+
+// Widest lane count this CPU runs in vector instructions: 8, 4 or 1
+inline int widestLanes() {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx512f")) return 8;
+    if (__builtin_cpu_supports("avx2")) return 4;
+#endif
+    return 1;
+}
+
+template <class RNG, int W>
+class LaneSimulator {
+
+private:
+    struct Lane {
+        RNG rng;
+        GaussianBuffer noise;
+        int run;        // realization in this lane, -1 if idle
+        Lane() : rng(0), run(-1) {
+        }
+    };
+
+    int steps;
+    int seed;
+    SimulatorParameters params;
+    LaneConstants constants;
+
+    LaneState<W> state;
+    Lane lanes[W];
+    typename LaneKernel<W>::Step kernel;
+
+public:
+    // p: initial conditions and model parameters, as from Simulator::getParameters()
+    LaneSimulator(int steps, int seed, const SimulatorParameters &p) {
+        this->steps = steps;
+        this->seed = seed;
+        this->params = p;
+        constants = laneConstants(p);
+        const char* name;
+        kernel = LaneKernel<W>::select(name);
+    }
+
+    // instruction set of the step on this CPU: "AVX-512", "AVX2" or "scalar"
+    static const char* kernelName() {
+        const char* name;
+        LaneKernel<W>::select(name);
+        return name;
+    }
+
+    /* run realizations from jobs until it has none left */
+    template <class Jobs>
+    void run(Jobs &jobs) {
+        TimerRegion region("lanes");
+        int busy = 0;
+        for (int l = 0; l < W; l++) {
+            reset(l);
+            busy += start(l, jobs);
+        }
+        alignas(64) double g[W];
+        while (busy > 0) {
+            for (int l = 0; l < W; l++) {
+                g[l] = lanes[l].run >= 0 ? lanes[l].noise.next(lanes[l].rng) : 0.0;
+            }
+            unsigned negative = kernel(state, g, constants);
+            for (int l = 0; l < W; l++) {
+                if (lanes[l].run < 0) continue;
+                int i = (int) state.step[l];
+                jobs.record(i, getState(l));
+                if (((negative >> l) & 1) || i == steps - 1) {
+                    jobs.finish(lanes[l].run, i);
+                    reset(l);
+                    busy += start(l, jobs) - 1;
+                }
+            }
+        }
+    }
+
+    // state of lane l
+    SimulatorState getState(int l) const {
+        SimulatorState s;
+        s.tau = state.tau[l];
+        s.a = state.a[l];
+        s.N = state.N[l];
+        s.V = state.V[l];
+        s.S = state.S[l];
+        s.rhomat = state.rhomat[l];
+        s.rhorad = state.rhorad[l];
+        s.lambda = state.lambda[l];
+        s.eta = state.eta[l];
+        return s;
+    }
+
+private:
+    // Put the next realization into lane l and record its step 0; 1 if there was one
+    template <class Jobs>
+    int start(int l, Jobs &jobs) {
+        int r = jobs.next();
+        lanes[l].run = r;
+        if (r < 0) return 0;
+        InitStream(lanes[l].rng, seed, r);
+        lanes[l].noise.clear();
+        jobs.record(0, getState(l));
+        if (steps < 2) {
+            jobs.finish(r, 0);
+            return start(l, jobs);
+        }
+        return 1;
+    }
+
+    // Lane l back to step 0
+    void reset(int l) {
+        laneReset(state, l, params, params.ell);
+    }
+};
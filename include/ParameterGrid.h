@@ -0,0 +1,321 @@
+/*----------------------------------------------------------------
+ *
+ *  Written:       17/10/2026
+ *  Last updated:  17/10/2026
+ *
+ *
+ *  Model parameters from the command line or a config file, and
+ *  grids over them that expand into a list of jobs. Use as follows:
+ *
+ *  SimulatorParameters base = defaultParameters();
+ *  ParameterGrid grid;
+ *  grid.parse("set", "alpha=3", base);
+ *  grid.parse("log-grid", "rhomat0=1E18:1E20:5", base);
+ *  grid.readConfig("scan.cfg", base);
+ *  std::vector<SimulatorParameters> jobs = grid.expand(base);
+ *
+ *  The parameters are a0, tau0, deltatau, rhomat0, rhorad0, lambda0
+ *  and alpha (ell = alpha * LPLANCK). The keys are
+ *
+ *  set NAME=VALUE              fix NAME to VALUE
+ *  grid NAME=LO:HI[:N]         sweep NAME over N evenly spaced values
+ *  log-grid NAME=LO:HI[:N]     the same, evenly spaced in log(NAME)
+ *  lhs M                       M latin hypercube points instead
+ *
+ *  On the command line they are options (--set alpha=3), in a config
+ *  file one per line without the dashes; # starts a comment. a0,
+ *  deltatau and alpha must be positive, as set values and over the
+ *  whole range of a grid.
+ *
+ *  Without lhs the jobs are the Cartesian product of the grid axes,
+ *  the last axis varying fastest. With lhs M the range of every axis
+ *  is cut into M strata and every point takes a different stratum on
+ *  every axis (a random permutation per axis) at a random position
+ *  inside it, so M points cover each axis evenly however many axes
+ *  there are; N is not needed then. The draws come from
+ *  CRandomMersenne seeded with base.seed, so the points are the same
+ *  for the same seed. Every job keeps base.seed and base.run: all
+ *  jobs run on the same noise.
+ *
+ *----------------------------------------------------------------*/
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <vector>
+#include "Simulator.h"
+
+class ParameterGrid {
+
+public:
+    // number of parameters that can be set or swept
+    static const int COUNT = 7;
+
+private:
+    /* one swept parameter */
+    struct Axis {
+        int parameter;  // index, see name()
+        double lo;
+        double hi;
+        int n;          // values of the Cartesian grid, 0 if not given
+        bool log;       // evenly spaced in log
+    };
+
+    std::vector<Axis> axes;
+    int lhs;            // latin hypercube points, 0 for the Cartesian product
+
+public:
+    ParameterGrid() : lhs(0) {
+    }
+
+    static const char* name(int k) {
+        static const char* const names[COUNT] = {
+            "a0", "tau0", "deltatau", "rhomat0", "rhorad0", "lambda0", "alpha"
+        };
+        return names[k];
+    }
+
+    // index of parameter name, -1 if there is none
+    static int find(const char* name, size_t length) {
+        for (int k = 0; k < COUNT; k++) {
+            if (strlen(ParameterGrid::name(k)) == length && strncmp(ParameterGrid::name(k), name, length) == 0) {
+                return k;
+            }
+        }
+        return -1;
+    }
+
+    // a0, deltatau and alpha: a scale factor, time step and length
+    static bool positive(int k) {
+        return k == 0 || k == 2 || k == 6;
+    }
+
+    static double get(const SimulatorParameters &p, int k) {
+        switch (k) {
+            case 0: return p.a0;
+            case 1: return p.tau0;
+            case 2: return p.deltatau;
+            case 3: return p.rhomat0;
+            case 4: return p.rhorad0;
+            case 5: return p.lambda0;
+            default: return p.ell / LPLANCK;
+        }
+    }
+
+    static void set(SimulatorParameters &p, int k, double value) {
+        switch (k) {
+            case 0: p.a0 = value; break;
+            case 1: p.tau0 = value; break;
+            case 2: p.deltatau = value; break;
+            case 3: p.rhomat0 = value; break;
+            case 4: p.rhorad0 = value; break;
+            case 5: p.lambda0 = value; break;
+            default: p.ell = value * LPLANCK; break;
+        }
+    }
+
+    /* Apply key (set, grid, log-grid or lhs) with its value; set changes
+     * base. Returns false, after saying why, if they can't be used. */
+    bool parse(const char* key, const char* value, SimulatorParameters &base) {
+        if (strcmp(key, "lhs") == 0) {
+            char* end;
+            long m = strtol(value, &end, 10);
+            if (end == value || *end != '\0' || m < 1) {
+                fprintf(stderr, "lhs needs a number of points, not %s\n", value);
+                return false;
+            }
+            lhs = (int) m;
+            return true;
+        }
+
+        bool grid = strcmp(key, "grid") == 0 || strcmp(key, "log-grid") == 0;
+        if (!grid && strcmp(key, "set") != 0) {
+            fprintf(stderr, "Unknown key %s\n", key);
+            return false;
+        }
+        const char* equals = strchr(value, '=');
+        int k = equals ? find(value, equals - value) : -1;
+        if (k < 0) {
+            fprintf(stderr, "%s needs NAME=..., NAME one of a0 tau0 deltatau rhomat0 rhorad0 lambda0 alpha, not %s\n",
+                    key, value);
+            return false;
+        }
+
+        // one to three numbers separated by colons
+        double x[3];
+        int count = 0;
+        const char* s = equals + 1;
+        char* end;
+        for (;;) {
+            x[count] = strtod(s, &end);
+            if (end == s) break;
+            count++;
+            if (*end != ':' || count == 3) break;
+            s = end + 1;
+        }
+        if (*end != '\0' || (grid ? count < 2 : count != 1)) {
+            fprintf(stderr, grid ? "%s needs NAME=LO:HI[:N], not %s\n" : "%s needs NAME=VALUE, not %s\n", key, value);
+            return false;
+        }
+        if (positive(k) && !(x[0] > 0 && (!grid || x[1] > 0))) {
+            fprintf(stderr, "%s %s: %s must be positive\n", key, value, name(k));
+            return false;
+        }
+        if (!grid) {
+            set(base, k, x[0]);
+            return true;
+        }
+
+        Axis axis;
+        axis.parameter = k;
+        axis.lo = x[0];
+        axis.hi = x[1];
+        axis.n = count == 3 ? (int) x[2] : 0;
+        axis.log = key[0] == 'l';
+        if ((count == 3 && (x[2] < 1 || x[2] != axis.n)) || (axis.log && (axis.lo <= 0 || axis.hi <= 0))) {
+            fprintf(stderr, "%s %s: N must be a positive integer, LO and HI positive on a log grid\n", key, value);
+            return false;
+        }
+        for (size_t d = 0; d < axes.size(); d++) {
+            if (axes[d].parameter == k) {
+                fprintf(stderr, "%s is swept twice\n", name(k));
+                return false;
+            }
+        }
+        axes.push_back(axis);
+        return true;
+    }
+
+    /* Apply every "key value" line of a config file */
+    bool readConfig(const char* inputFilename, SimulatorParameters &base) {
+        FILE *ifp = fopen(inputFilename, "r");
+
+        if (ifp == NULL) {
+          fprintf(stderr, "Can't open input file %s!\n",
+                  inputFilename);
+          exit(1);
+        }
+
+        char line[512];
+        bool ok = true;
+        for (int number = 1; ok && fgets(line, sizeof(line), ifp) != NULL; number++) {
+            char* hash = strchr(line, '#');
+            if (hash != NULL) *hash = '\0';
+            char* key = line;
+            while (isspace((unsigned char) *key)) key++;
+            if (*key == '\0') continue;
+            char* value = key;
+            while (*value != '\0' && !isspace((unsigned char) *value)) value++;
+            if (*value != '\0') *value++ = '\0';
+            while (isspace((unsigned char) *value)) value++;
+            char* last = value + strlen(value);
+            while (last > value && isspace((unsigned char) last[-1])) *--last = '\0';
+            ok = parse(key, value, base);
+            if (!ok) {
+                fprintf(stderr, "in line %d of %s\n", number, inputFilename);
+            }
+        }
+        fclose(ifp);
+        return ok;
+    }
+
+    // no grid given: a single job
+    bool empty() const {
+        return axes.empty();
+    }
+
+    int getAxes() const {
+        return (int) axes.size();
+    }
+
+    // parameter swept by axis d, see name()
+    int getParameter(int d) const {
+        return axes[d].parameter;
+    }
+
+    /* Check the grid can be expanded; false, after saying why, if not */
+    bool check() const {
+        if (lhs > 0 && axes.empty()) {
+            fprintf(stderr, "lhs needs at least one grid\n");
+            return false;
+        }
+        if (lhs > 0) return true;
+        double points = 1.0;
+        for (size_t d = 0; d < axes.size(); d++) {
+            if (axes[d].n == 0) {
+                fprintf(stderr, "grid %s needs a number of values (LO:HI:N) without lhs\n", name(axes[d].parameter));
+                return false;
+            }
+            points *= axes[d].n;
+        }
+        if (points > 1E8) {
+            fprintf(stderr, "The grid has %.0f points, more than 10^8\n", points);
+            return false;
+        }
+        return true;
+    }
+
+    /* base with every combination of grid values, or the latin
+     * hypercube points; just base without a grid */
+    std::vector<SimulatorParameters> expand(const SimulatorParameters &base) const {
+        std::vector<SimulatorParameters> jobs;
+        int D = (int) axes.size();
+        if (lhs > 0) {
+            CRandomMersenne rng(base.seed);
+            std::vector<std::vector<int> > strata(D, std::vector<int>(lhs));
+            for (int d = 0; d < D; d++) {
+                for (int j = 0; j < lhs; j++) {
+                    strata[d][j] = j;
+                }
+                // Fisher-Yates
+                for (int j = lhs - 1; j > 0; j--) {
+                    int r = rng.IRandom(0, j);
+                    int t = strata[d][j];
+                    strata[d][j] = strata[d][r];
+                    strata[d][r] = t;
+                }
+            }
+            for (int j = 0; j < lhs; j++) {
+                SimulatorParameters p = base;
+                for (int d = 0; d < D; d++) {
+                    set(p, axes[d].parameter, value(axes[d], (strata[d][j] + rng.Random()) / lhs));
+                }
+                jobs.push_back(p);
+            }
+            return jobs;
+        }
+
+        int points = 1;
+        for (int d = 0; d < D; d++) {
+            points *= axes[d].n;
+        }
+        for (int j = 0; j < points; j++) {
+            SimulatorParameters p = base;
+            int rest = j;
+            for (int d = D - 1; d >= 0; d--) {
+                int n = axes[d].n;
+                int i = rest % n;
+                rest /= n;
+                set(p, axes[d].parameter, value(axes[d], n > 1 ? (double) i / (n - 1) : 0.0));
+            }
+            jobs.push_back(p);
+        }
+        return jobs;
+    }
+
+private:
+    // value at fraction t of the range of axis
+    static double value(const Axis &axis, double t) {
+        // the ends exactly as given
+        if (t == 0.0) return axis.lo;
+        if (t == 1.0) return axis.hi;
+        if (axis.log) {
+            return exp(log(axis.lo) + t * (log(axis.hi) - log(axis.lo)));
+        }
+        return axis.lo + t * (axis.hi - axis.lo);
+    }
+};
@@ -0,0 +1,147 @@
+/*----------------------------------------------------------------
+ *
+ *  Written:       17/10/2026
+ *  Last updated:  17/10/2026
+ *
+ *
+ *  Runs a list of parameter sets, e.g. the jobs of a ParameterGrid,
+ *  in one process on a pool of threads. Use as follows:
+ *
+ *  ParameterScan<CRandomPhilox> scan(steps, grid.expand(base), threads);
+ *  scan.run();
+ *  scan.printToFile("lambda-grid.txt");
+ *
+ *  Every worker owns one Simulator and moves it from job to job with
+ *  setParameters(), so the jobs reuse its generator and noise buffer
+ *  instead of each building their own, and no job stores its
+ *  trajectory. Job k runs realization (seed, run) of jobs[k]; of it
+ *  the last step, the state there and the mean and standard deviation
+ *  of lambda over the steps are kept. The result of a job does not
+ *  depend on the number of threads.
+ *
+ *----------------------------------------------------------------*/
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "Simulator.h"
+#include "ParameterGrid.h"
+
+// What is kept of one job; the Simulator's sink
+struct ScanResult {
+    int laststep;
+    SimulatorState last;
+    long long count;    // steps recorded
+    double mean;        // running mean of lambda
+    double m2;          // sum of (lambda - mean)^2
+
+    void clear() {
+        laststep = 0;
+        count = 0;
+        mean = 0.0;
+        m2 = 0.0;
+    }
+
+    void record(int i, const SimulatorState &s) {
+        laststep = i;
+        last = s;
+        count++;
+        double delta = s.lambda - mean;
+        mean += delta / count;
+        m2 += delta * (s.lambda - mean);
+    }
+
+    double getSdev() const {
+        return count > 1 ? sqrt(m2 / (count - 1)) : 0.0;
+    }
+};
+
+template <class RNG>
+class ParameterScan {
+
+private:
+    int steps;
+    int threads;
+    std::vector<SimulatorParameters> jobs;
+    std::vector<ScanResult> results;
+
+    /* next job to be handed out */
+    std::atomic<int> next;
+
+public:
+    ParameterScan(int steps, const std::vector<SimulatorParameters> &jobs, int threads)
+        : jobs(jobs), results(jobs.size()) {
+        this->steps = steps;
+        this->threads = threads > 0 ? threads : 1;
+        this->next = 0;
+    }
+
+    /* run all jobs */
+    void run() {
+        TimerRegion region("scan");
+        std::vector<std::thread> pool;
+        next = 0;
+        for (int t = 0; t < threads; t++) {
+            pool.push_back(std::thread(&ParameterScan::work, this));
+        }
+        for (int t = 0; t < threads; t++) {
+            pool[t].join();
+        }
+    }
+
+    int getCount() const {
+        return (int) jobs.size();
+    }
+
+    const SimulatorParameters& getJob(int k) const {
+        return jobs[k];
+    }
+
+    const ScanResult& getResult(int k) const {
+        return results[k];
+    }
+
+    /* write the parameters and the result of every job, one row each */
+    void printToFile(const char* outputFilename) {
+        FILE *ofp = fopen(outputFilename, "w");
+
+        if (ofp == NULL) {
+          fprintf(stderr, "Can't open output file %s!\n",
+                  outputFilename);
+          exit(1);
+        }
+
+        fprintf(ofp, "#");
+        for (int p = 0; p < ParameterGrid::COUNT; p++) {
+            fprintf(ofp, " %s\t", ParameterGrid::name(p));
+        }
+        fprintf(ofp, " laststep\t tau\t lambda\t mean(lambda)\t sdev(lambda)\n");
+        for (size_t k = 0; k < jobs.size(); k++) {
+            for (int p = 0; p < ParameterGrid::COUNT; p++) {
+                fprintf(ofp, "%E\t", ParameterGrid::get(jobs[k], p));
+            }
+            const ScanResult &r = results[k];
+            fprintf(ofp, "%d\t%E\t%E\t%E\t%E\n", r.laststep, r.last.tau, r.last.lambda, r.mean, r.getSdev());
+        }
+        fclose(ofp);
+    }
+
+private:
+    /* worker loop: pull jobs until none are left */
+    void work() {
+        int k = next++;
+        if (k >= (int) jobs.size()) return;
+        Simulator<RNG> simulator(steps, jobs[k], false);
+        for (; k < (int) jobs.size(); k = next++) {
+            TimerRegion region("job");
+            simulator.setParameters(jobs[k]);
+            results[k].clear();
+            simulator.runSimulation(results[k]);
+        }
+    }
+};
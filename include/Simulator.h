@@ -0,0 +1,443 @@
+/*----------------------------------------------------------------
+ *
+ *  Written:       25/07/2014
+ *  Last updated:  17/10/2026
+ *
+ *
+ *  Simulator for one realization of fluctuating lambda. Use as follows:
+ *
+ *  Simulator<CRandomPhilox> simulator(steps, seed, run, false);
+ *  simulator.runSimulation();
+ *  simulator.printToFile();
+ *
+ *  Every Simulator owns its random number generator and passes it
+ *  to doStep, so any number of Simulators may run concurrently. The
+ *  generator type RNG is any randomc generator; it is fixed at compile
+ *  time so draws are direct calls. Its stream is selected by
+ *  (seed, run) (see InitStream in random.h), so realization run of
+ *  an ensemble can be regenerated on its own.
+ *
+ *  The recurrence only needs the current SimulatorState. To stream
+ *  the steps instead of keeping them, pass a sink:
+ *
+ *  TrajectoryWriter writer("trajectory.txt", 65536);
+ *  simulator.runSimulation(writer);
+ *
+ *  Memory then stays constant in the number of steps. Only
+ *  runSimulation() without a sink allocates the full Trajectory
+ *  that printToFile and the getters read from. The second template
+ *  parameter is the column policy of that Trajectory (see
+ *  Trajectory.h); to keep only what printToFile writes:
+ *
+ *  Simulator<CRandomPhilox, LambdaColumns> simulator(steps, seed, run, false);
+ *
+ *  --check-volume needs a, V and tau, so it is refused with columns
+ *  that drop them.
+ *
+ *  The initial conditions and alpha default to defaultParameters();
+ *  to run others, pass them in (p.seed and p.run select the stream):
+ *
+ *  SimulatorParameters p = defaultParameters();
+ *  p.ell = 3.0 * LPLANCK;
+ *  Simulator<CRandomPhilox> simulator(steps, p, false);
+ *
+ *  setParameters() switches a Simulator to other parameters without
+ *  reallocating, so one Simulator can run a whole list of them.
+ *
+ *  The Trajectory of runSimulation() (and y when checking the volume)
+ *  is carved from the Arena of the thread, which every run resets, so
+ *  back-to-back runs on a thread map their memory once and never page
+ *  fault after the first. A Simulator holds the arena while it keeps
+ *  its steps; another one running on the same thread meanwhile uses
+ *  an arena of its own.
+ *
+ *----------------------------------------------------------------*/
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmath>
+#include <math.h>
+#include <ctime>
+#include <new>
+#include <type_traits>
+#include "tools/random.h"
+#include "tools/ziggurat.h"
+#include "VolumeEngine.h"
+#include "Trajectory.h"
+#include "Timer.h"
+#include "StepProfile.h"
+#include "Arena.h"
+
+// SI UNITS AND CONSTANTS
+const double PI = M_PI;
+const double HBAR    = 1.05457173E-34; // m^2 * kg / s
+//double HBAR    = 1.0;
+const double CLIGHT  = 299792458.0;    // m / s
+//double CLIGHT  = 1.0;
+const double GNEWTON = 6.67384E-11;    // m^3 / kg / s^2
+//double GNEWTON = 1.0;
+const double LPLANCK = pow(8.0 * PI * GNEWTON * HBAR / pow(CLIGHT, 3.0), 0.5);
+//double LPLANCK = 1.0;
+const double TPLANCK = pow(8.0 * PI * GNEWTON * HBAR / pow(CLIGHT, 5.0), 0.5);
+//double TPLANCK = 1.0;
+const double KAPPA = 8.0 * PI * GNEWTON * pow(CLIGHT, -4.0); // TIME^2 / MASS / LENGTH
+const double AGEOFUNIVERSE = 4.3E17;   // s
+const double HUBBLE0 = 2.20E-18;       // 1 / s
+
+// Initial conditions and model parameters used unless others are given
+inline SimulatorParameters defaultParameters() {
+    SimulatorParameters p;
+    p.seed = 0;
+    p.run = 0;
+    // free parameter ell
+    double alpha = 2.5;
+    p.ell = alpha * LPLANCK;
+    //p.deltatau = (AGEOFUNIVERSE / TPLANCK) / steps;
+    p.deltatau = 1.0;
+    p.tau0 = 1;
+    //p.tau0 = TPLANCK;
+    p.a0 = 1.99716E-10;
+    p.V0 = 0.0;
+    p.rhomat0 = 2.98428E19; //DIMENSIONFUL!
+    p.rhorad0 = 4.01871E25; //DIMENSIONFUL!
+    p.lambda0 = 0.0;
+    return p;
+}
+
+// Simulator Class
+template <class RNG, class Columns = AllColumns>
+class Simulator {
+
+private:
+    // seed and realization number, and the generator stream they select
+    int seed;
+    int run;
+    RNG rng;
+    GaussianBuffer noise;   // ziggurat normals, drawn from rng in blocks
+
+    // number of steps
+    int steps;
+
+    // free parameter ell
+    double ell;
+
+    // O(1) volume update; the exact O(N^2) loop is kept for checking only
+    VolumeEngine volume;
+    bool checkvolume;   // compare engine against the exact loop at every step
+    double maxvolumeerror; // largest relative deviation seen when checking
+    double* y;          // temp variables sum_k^i(dt/a), only kept when checking the volume
+
+    // state of the current step and of the one before it
+    SimulatorState cur;
+    SimulatorState prev;
+    double root;        // expansion rate squared at prev
+
+    // all steps, only allocated by runSimulation()
+    TrajectoryOf<Columns>* trajectory;
+
+    // the columns checkVolume reads are kept
+    static const bool CHECKABLE = Columns::a == STORED && Columns::V == STORED && Columns::tau != DROPPED;
+
+    // memory of trajectory and y: Arena::local(), or own while that is
+    // held by another Simulator; NULL before runSimulation()
+    Arena* arena;
+    Arena own;
+
+    // initial conditions and model parameters
+    double a0;          // initial scale factor
+    double tau0;        // initial time
+    double deltatau;    // time increment (if constant)
+    double V0;          // initial volume
+    double rhomat0;     // initial matter energy density
+    double rhorad0;     // initial radiation energy density
+    double lambda0;     // initial dark energy density
+    int ifinish;        // final step value when root becomes negative
+
+    // per-phase cycle counters, only with -DLAMBDA_INSTRUMENT
+    PROFILE_MEMBER(profile);
+
+    // sink for runSimulation(): keeps every step and checks the volume if asked
+    struct Recorder {
+        Simulator* sim;
+        void record(int i, const SimulatorState &s) {
+            sim->trajectory->record(i, s);
+            if (sim->checkvolume && i > 0) {
+                sim->checkVolume(i - 1);
+            }
+        }
+    };
+
+public:
+    // Class constructor, seeded with the current time
+    Simulator(int steps) : seed((int) time(0)), run(0), rng(seed) {
+        this->checkvolume = false;
+        this->initialize(steps, defaultParameters());
+    }
+
+    // Class constructor for realization run under the given seed, optionally
+    // checking the volume engine against the exact loop
+    Simulator(int steps, int seed, int run, bool checkvolume) : seed(seed), run(run), rng(seed) {
+        InitStream(rng, seed, run);
+        this->checkvolume = checkvolume;
+        this->initialize(steps, defaultParameters());
+    }
+
+    // Class constructor for realization p.run under p.seed with the
+    // initial conditions and model parameters of p
+    Simulator(int steps, const SimulatorParameters &p, bool checkvolume) : seed(p.seed), run(p.run), rng(p.seed) {
+        InitStream(rng, seed, run);
+        this->checkvolume = checkvolume;
+        this->initialize(steps, p);
+    }
+
+    // Class destructor
+    ~Simulator() {
+        release();
+    }
+
+public:
+    // Run and keep all steps in memory
+    void runSimulation() {
+        release();
+        arena = Arena::local().claim(this) ? &Arena::local() : &own;
+        arena->reset();
+        size_t bytes = Arena::aligned(sizeof(TrajectoryOf<Columns>)) + TrajectoryOf<Columns>::bytes(steps);
+        if (checkvolume) {
+            bytes += Arena::aligned(steps * sizeof(double));
+        }
+        arena->reserve(bytes);
+        trajectory = new (arena->allocate<TrajectoryOf<Columns> >(1)) TrajectoryOf<Columns>(steps, *arena, getParameters());
+        if (checkvolume) {
+            y = arena->allocate<double>(steps);
+            for (int i = 0; i < steps; i++) {
+                y[i] = 0.0;
+            }
+        }
+        Recorder recorder = { this };
+        runSimulation(recorder);
+    }
+
+    // Run and hand every step to sink.record(i, state) instead of storing it
+    template <class Sink>
+    void runSimulation(Sink &sink) {
+        TimerRegion region("runSimulation");
+        reset();
+        sink.record(0, cur);
+        for (int i = 0; i < steps - 1; i++) {
+            doStep(i, rng);
+            PROFILE_START(t);
+            sink.record(i + 1, cur);
+            PROFILE_PHASE(profile, SINK, t);
+            if (root < 0) {
+                PROFILE_COUNT(profile, breaks);
+                break;
+            }
+            //printf("%d: tau=%E a=%E rhorad=%E rhomat=%E rhoratio=%E root=%E\n", i, prev.tau, prev.a, prev.rhorad, prev.rhomat, (prev.lambda / KAPPA) / 5.36934E-10 , root);
+        }
+        PROFILE_COUNT(profile, runs);
+        PROFILE_SUBMIT(profile);
+    }
+
+    void printSummary() {
+        printf("delta-tau = %E\n", deltatau);
+        printf("Managed %i steps\n" , ifinish);
+        if (checkvolume) {
+            printf("Volume engine: max relative deviation from exact loop = %E\n", maxvolumeerror);
+        }
+        printf("%d: tau=%E a=%E rhorad=%E rhomat=%E rhoratio=%E root=%E\n", ifinish, prev.tau, prev.a, prev.rhorad, prev.rhomat, (prev.lambda / KAPPA) / 5.36934E-10 , root);
+    }
+
+    // Advance cur from step i to step i + 1
+    void doStep(int i, RNG &gen) {
+        PROFILE_START(t);
+        PROFILE_COUNT(profile, steps);
+        ifinish = i;
+        prev = cur;
+        // New scale factor
+        //root = (prev.rhorad + prev.rhomat) * (8.0 * PI * GNEWTON * pow(CLIGHT, -2.0)) / 3.0;
+        root = (prev.rhorad + prev.rhomat + prev.lambda / KAPPA) * 8.0 * PI * GNEWTON * pow(CLIGHT, -2.0) / 3.0;
+        cur.tau = tau0 + (i + 1) * deltatau;
+        double dt = cur.tau - prev.tau;
+        cur.a = prev.a * (1.0 + sqrt(root) * dt);
+        PROFILE_PHASE(profile, SCALE, t);
+
+        // New volume
+        cur.V = volume.push(prev.a, dt);
+        cur.eta = volume.getConformalTime();
+        cur.V = pow(CLIGHT, 4.0) * 4.0 * PI / 3.0 * cur.V;
+
+        // New Cardinality
+        cur.N = cur.V / pow(ell, 4.0);
+        PROFILE_PHASE(profile, VOLUME, t);
+
+        // New Action
+        double g = noise.next(gen);
+        PROFILE_PHASE(profile, RNG, t);
+        cur.S = prev.S + g * sqrt(cur.N - prev.N) * HBAR;
+
+        // New lambda
+        cur.lambda = CLIGHT * KAPPA * cur.S / cur.V;
+
+        // New rho
+        cur.rhomat = rhomat0 * pow(a0 / cur.a, 3.0);
+        cur.rhorad = rhorad0 * pow(a0 / cur.a, 4.0);
+        PROFILE_PHASE(profile, UPDATE, t);
+    }
+
+    void printToFile() {
+        FILE *ofp;
+        char outputFilename[] = "lambda.txt";
+        ofp = fopen(outputFilename, "w");
+
+        if (ofp == NULL) {
+          fprintf(stderr, "Can't open output file %s!\n",
+                  outputFilename);
+          exit(1);
+        }
+
+        for(int i = 0; i <= getLastStep(); i++) {
+            fprintf(ofp, "%E\t%E\n", trajectory->getTau(i), trajectory->getLambda(i));
+        }
+        fclose(ofp);
+    }
+
+    // number of allocated steps
+    int getSteps() const {
+        return steps;
+    }
+
+    // last step index holding valid data (smaller than steps - 1 after an early break)
+    int getLastStep() const {
+        return ifinish + 1;
+    }
+
+    // state after the last step
+    const SimulatorState& getState() const {
+        return cur;
+    }
+
+    // initial conditions, model parameters and stream of this run
+    SimulatorParameters getParameters() const {
+        SimulatorParameters p;
+        p.seed = seed;
+        p.run = run;
+        p.a0 = a0;
+        p.tau0 = tau0;
+        p.deltatau = deltatau;
+        p.V0 = V0;
+        p.rhomat0 = rhomat0;
+        p.rhorad0 = rhorad0;
+        p.lambda0 = lambda0;
+        p.ell = ell;
+        return p;
+    }
+
+    // Switch to realization p.run under p.seed with the parameters of p;
+    // the next run starts from them, reusing what is allocated
+    void setParameters(const SimulatorParameters &p) {
+        seed = p.seed;
+        run = p.run;
+        InitStream(rng, seed, run);
+        setInitialConditions(p);
+        reset();
+    }
+
+    // stored steps of runSimulation(), NULL after a streamed run
+    const TrajectoryOf<Columns>* getTrajectory() const {
+        return trajectory;
+    }
+
+    const double* getTau() const {
+        return trajectory ? trajectory->getTau() : NULL;
+    }
+
+    const double* getLambda() const {
+        return trajectory ? trajectory->getLambda() : NULL;
+    }
+
+private:
+    // Recompute the volume sum with the exact O(i) loop and record the deviation
+    void checkVolume(int i) {
+        checkVolume(i, std::integral_constant<bool, CHECKABLE>());
+    }
+
+    void checkVolume(int i, std::false_type) {
+    }
+
+    void checkVolume(int i, std::true_type) {
+        const TrajectoryOf<Columns> &t = *trajectory;
+        double exact = 0.0;
+        for(int k = 0; k < i + 1; k++) {
+            y[k] += (t.getTau(i + 1) - t.getTau(i)) / t.getA(i);
+            exact += pow(t.getA(k) * y[k], 3.0) * (t.getTau(k + 1) - t.getTau(k));
+        }
+        exact = pow(CLIGHT, 4.0) * 4.0 * PI / 3.0 * exact;
+        double error = fabs(t.getV(i + 1) - exact) / exact;
+        if (error > maxvolumeerror) {
+            maxvolumeerror = error;
+        }
+    }
+
+    void initialize(int steps, const SimulatorParameters &p) {
+        if (checkvolume && !CHECKABLE) {
+            fprintf(stderr, "Checking the volume needs the columns a, V and tau\n");
+            exit(1);
+        }
+
+        // Set number of steps
+        this->steps = steps;
+        setInitialConditions(p);
+
+        y = NULL;
+        trajectory = NULL;
+        arena = NULL;
+        reset();
+    }
+
+    // Drop the stored steps and the arena; their memory stays with it
+    void release() {
+        if (trajectory != NULL) {
+            trajectory->~TrajectoryOf<Columns>();
+            trajectory = NULL;
+        }
+        y = NULL;
+        if (arena != NULL) {
+            arena->unclaim(this);
+            arena = NULL;
+        }
+    }
+
+    // Set free parameter ell and initial values
+    void setInitialConditions(const SimulatorParameters &p) {
+        ell = p.ell;
+        deltatau = p.deltatau;
+        tau0 = p.tau0;
+        a0 = p.a0;
+        V0 = p.V0;
+        rhomat0 = p.rhomat0;
+        rhorad0 = p.rhorad0;
+        lambda0 = p.lambda0;
+    }
+
+    // Back to step 0
+    void reset() {
+        ifinish = 0;
+        root = 0.0;
+        maxvolumeerror = 0.0;
+        volume.reset();
+        noise.clear();
+
+        cur.a = a0;
+        cur.lambda = lambda0;
+        cur.rhomat = rhomat0;
+        cur.rhorad = rhorad0;
+        cur.tau = tau0;
+        cur.V = V0;
+        cur.eta = 0.0;
+        cur.N = V0 / pow(ell, 4.0);
+        cur.S = 0.0;
+        prev = cur;
+    }
+};
@@ -1,29 +1,48 @@
 /*----------------------------------------------------------------
  *
  *  Written:       14/02/2014
- *  Last updated:  14/02/2014
+ *  Last updated:  17/10/2026
  *
  *
  *  This is a statistics class. Use as follows:
  *
  *  Statistics myStats = new Statistics(...);
  *
- *  When fed with new data points x, the class keeps track of
- *  s1 = sum(x) and s2 = sum(x*x) (as described on e.g.
- *  Wikipedia) to calculate the running sample mean
+ *  When fed with new data points x, the class keeps track of the
+ *  running mean and the central moment sums
  *
- *  mean = s1 / N
+ *  M_k = sum (x - mean)^k,    k = 2, 3, 4,
  *
- *  and the sample standard deviation
+ *  updated one point at a time (Welford; higher moments after
+ *  Pebay 2008). Unlike s1 = sum(x) and s2 = sum(x*x) nothing
+ *  cancels, so the standard deviation is accurate even when it is
+ *  tiny compared to the mean, as for lambda. From these
  *
- *  sdev = sqrt((N * s1 - s2 * s2)/(N * (N - 1))).
+ *  sdev     = sqrt(M2 / (N - 1)),
+ *  skewness = sqrt(N) M3 / M2^(3/2),
+ *  kurtosis = N M4 / M2^2 - 3      (excess kurtosis).
+ *
+ *  Two instances are combined with merge() (Chan et al. 1979), so
+ *  every thread can push into its own Statistics without locking
+ *  and the results are reduced at the end:
+ *
+ *  Statistics total;
+ *  for (int t = 0; t < threads; t++) total.merge(partial[t]);
+ *
+ *  The update and merge formulas live in Moments, which classes that
+ *  keep many such sums (EnsembleReducer, one per step) use directly.
+ *
+ *  getQuantile(q) is exact when the data is kept. Otherwise the data
+ *  points go into a QuantileSketch of a few KB, which gives
+ *  percentiles with bounded rank error from any number of points
+ *  and is merged along with the moments.
  *
  *----------------------------------------------------------------*/
 
 #pragma once
 
 #include <math.h>
-#include <ctime>
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -32,7 +51,70 @@
 #include <iomanip>
 #include <sstream>
 #include <fstream>
-#include "StringTools.h"
+#include <algorithm>
+#include "QuantileSketch.h"
+
+// Count, running mean and central moment sums M2, M3, M4 of a stream
+struct Moments {
+    long long n;
+    double mean;
+    double m2;
+    double m3;
+    double m4;
+
+    void clear() {
+        n = 0;
+        mean = 0.0;
+        m2 = 0.0;
+        m3 = 0.0;
+        m4 = 0.0;
+    }
+
+    void push(double x) {
+        double n1 = (double) n;
+        n++;
+        double nn = (double) n;
+        double delta = x - mean;
+        double dn = delta / nn;
+        double dn2 = dn * dn;
+        double term = delta * dn * n1;
+        // m4 and m3 first, they need the old m2 and m3
+        mean += dn;
+        m4 += term * dn2 * (nn * nn - 3.0 * nn + 3.0) + 6.0 * dn2 * m2 - 4.0 * dn * m3;
+        m3 += term * dn * (nn - 2.0) - 3.0 * dn * m2;
+        m2 += term;
+    }
+
+    /* as if the points of other had been pushed here */
+    void merge(const Moments &other) {
+        if (other.n == 0) return;
+        if (n == 0) {
+            *this = other;
+            return;
+        }
+        double na = (double) n;
+        double nb = (double) other.n;
+        double nn = na + nb;
+        double delta = other.mean - mean;
+        double dn = delta / nn;
+        double dn2 = dn * dn;
+        double m4new = m4 + other.m4 + delta * dn2 * dn * na * nb * (na * na - na * nb + nb * nb)
+                     + 6.0 * dn2 * (na * na * other.m2 + nb * nb * m2)
+                     + 4.0 * dn * (na * other.m3 - nb * m3);
+        double m3new = m3 + other.m3 + delta * dn2 * na * nb * (na - nb)
+                     + 3.0 * dn * (na * other.m2 - nb * m2);
+        m2 += other.m2 + delta * dn * na * nb;
+        m3 = m3new;
+        m4 = m4new;
+        mean += dn * nb;
+        n += other.n;
+    }
+
+    /* sample variance, 0 for fewer than two points */
+    double getVariance() const {
+        return n > 1 ? m2 / (n - 1) : 0.0;
+    }
+};
 
 class Statistics {
 
@@ -41,32 +123,37 @@ private:
     bool keepdata;
     /* vector that optionally keeps all the data */
     std::vector<double> data;
-    /* starting time */
-    std::clock_t start;
+    /* quantile sketch used instead when the data is not kept */
+    QuantileSketch sketch;
+    /* starting time (wall time, steady_clock) */
+    std::chrono::steady_clock::time_point start;
     /* time of last call to clock */
-    std::clock_t lastcall;
+    std::chrono::steady_clock::time_point lastcall;
     /* number of calls made to clock */
     int calls;
     /* name of statistics object */
     std::string name;
-    /* size[i] = number of data points for ith variable*/
-    int s0;
-    /* s1[i] = s1 for ith variable*/
-    double s1;
-    /* s1[i] = standard deviation for ith variable*/
-    double s2;
+    /* number of data points, mean and m2, m3, m4 = sum of (x - mean)^2, ^3, ^4 */
+    Moments moments;
 
 public:
+    /*  Constructor for an unnamed accumulator that does not keep the data
+     *  and prints nothing, e.g. one per thread. */
+    Statistics() {
+        this->calls = 0;
+        this->clear();
+        this->keepdata = false;
+        start = std::chrono::steady_clock::now();
+        lastcall = start;
+    }
+
     /*  Constructor for one variable, keeping individual data points in the vector "data" */
     Statistics(const char* name) {
         this->calls = 0;
-        this->s0 = 0;
-        this->s1 = 0.0;
-        this->s2 = 0.0;
+        this->clear();
         this->name = name;
         this->keepdata = true;
-        this->data.resize(0);
-        start = std::clock();
+        start = std::chrono::steady_clock::now();
         lastcall = start;
         std::cout << "Starting statistics for \"" << name << "\"." << std::endl;
     }
@@ -76,44 +163,78 @@ public:
      *  are updated. Can be useful when memory is an issue. */
     Statistics(const char* name, bool _keepdata) {
         this->calls = 0;
-        this->s0 = 0;
-        this->s1 = 0.0;
-        this->s2 = 0.0;
+        this->clear();
         this->name = name;
         this->keepdata = _keepdata;
-        this->data.resize(0);
-        start = std::clock();
+        start = std::chrono::steady_clock::now();
         lastcall = start;
         std::cout << "Starting statistics for \"" << name << "\"." << std::endl;
     }
 
 private:
     void pushanddrop(double x) {
-        this->s0++;
-        this->s1 += x;
-        this->s2 += x * x;
+        moments.push(x);
     }
 
     void pushandkeep(double x) {
         data.push_back(x);
-        this->s0++;
-        this->s1 += x;
-        this->s2 += x * x;
+        pushanddrop(x);
+    }
+
+    void pushandsketch(double x) {
+        sketch.push(x);
+        pushanddrop(x);
+    }
+
+    /* wall time in seconds since t */
+    static double seconds(std::chrono::steady_clock::time_point t) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
     }
 
 public:
     /* Add new data-point to first variable */
     void push(double x) {
         if(keepdata) pushandkeep(x);
-        else pushanddrop(x);
+        else pushandsketch(x);
+    }
+
+    /*  Add all data points of other, as if they had been pushed here.
+     *  If only this instance keeps its data, it moves its data into the
+     *  sketch and stops keeping data. */
+    void merge(const Statistics &other) {
+        if (other.moments.n == 0) return;
+        if (keepdata && !other.keepdata) {
+            for (size_t i = 0; i < data.size(); i++) {
+                sketch.push(data[i]);
+            }
+            data.clear();
+            keepdata = false;
+        }
+        if (keepdata) {
+            data.insert(data.end(), other.data.begin(), other.data.end());
+        } else if (other.keepdata) {
+            for (size_t i = 0; i < other.data.size(); i++) {
+                sketch.push(other.data[i]);
+            }
+        } else {
+            sketch.merge(other.sketch);
+        }
+        moments.merge(other.moments);
+    }
+
+    /* forget all data points */
+    void clear() {
+        this->moments.clear();
+        this->data.resize(0);
+        this->sketch.clear();
     }
 
     //  records time taken since instantiation and
     //  prints it out to the console
     std::string stringTimeTotal() {
         std::ostringstream stream;
-        double t = (std::clock() - this->start) / (double) CLOCKS_PER_SEC;
-        this->lastcall = std::clock();
+        double t = seconds(this->start);
+        this->lastcall = std::chrono::steady_clock::now();
         stream << "Process \"" << name << "\" - Total Time: " << t << "s."
                 << std::endl;
         return stream.str();
@@ -123,8 +244,8 @@ public:
     //  prints it out to the console
     std::string getTime() {
         std::ostringstream stream;
-        double t = (std::clock() - this->lastcall) / (double) CLOCKS_PER_SEC;
-        this->lastcall = std::clock();
+        double t = seconds(this->lastcall);
+        this->lastcall = std::chrono::steady_clock::now();
         this->calls++;
         stream  << std::setprecision(5)
                 << "PROCESS \""
@@ -141,18 +262,52 @@ public:
     /* get stats for first variable */
     std::vector<double> getStats() {
         std::vector<double> out(3);
-        out[0] = s0;
-        out[1] = s1 / s0;
-        out[2] = sqrt((s0 * s2 - s1 * s1)/ (s0 * (s0 - 1)));
+        out[0] = moments.n;
+        out[1] = getMean();
+        out[2] = getSdev();
         return out;
     }
 
-    double getMean() {
-        return s1 / s0;
+    long long getCount() const {
+        return moments.n;
+    }
+
+    double getMean() const {
+        return moments.mean;
+    }
+
+    double getVariance() const {
+        return moments.getVariance();
+    }
+
+    double getSdev() const {
+        return sqrt(getVariance());
+    }
+
+    double getSkewness() const {
+        return sqrt((double) moments.n) * moments.m3 / pow(moments.m2, 1.5);
+    }
+
+    /* excess kurtosis, 0 for a gaussian */
+    double getKurtosis() const {
+        return moments.n * moments.m4 / (moments.m2 * moments.m2) - 3.0;
+    }
+
+    /*  q-quantile, 0 <= q <= 1: interpolated between the order statistics
+     *  of the kept data, or estimated by the sketch */
+    double getQuantile(double q) {
+        if (!keepdata) return sketch.getQuantile(q);
+        if (data.empty()) return NAN;
+        std::vector<double> sorted(data);
+        std::sort(sorted.begin(), sorted.end());
+        double h = q * (sorted.size() - 1);
+        size_t i = (size_t) h;
+        if (i + 1 >= sorted.size()) return sorted.back();
+        return sorted[i] + (h - i) * (sorted[i + 1] - sorted[i]);
     }
 
-    double getSdev() {
-        return sqrt((s0 * s2 - s1 * s1)/ (s0 * (s0 - 1)));
+    double getMedian() {
+        return getQuantile(0.5);
     }
 
     /* toString() */
@@ -161,7 +316,7 @@ public:
         std::vector<double> results = this->getStats();
         stream << std::setw(8) << std::setprecision(3);
         stream << std::scientific;
-        stream << (std::clock() - this->start) / (double) CLOCKS_PER_SEC << "\t";
+        stream << seconds(this->start) << "\t";
         stream << std::fixed << std::setw(8) << std::setprecision(0) << std::right;
         stream << results[0] << "\t";
         stream << std::setw(8) << std::setprecision(3);
@@ -181,7 +336,7 @@ public:
         if(!keepdata) throw "Data was not kept";
         std::ofstream os;
         os.open(name);
-        for(int i = 0; i < data.size(); i++) {
+        for(size_t i = 0; i < data.size(); i++) {
             os << data[i] << "\n";
         }
     }
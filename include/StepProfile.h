@@ -0,0 +1,141 @@
+/*----------------------------------------------------------------
+ *
+ *  Written:       17/10/2026
+ *  Last updated:  17/10/2026
+ *
+ *
+ *  Cycle counters for the phases of Simulator::doStep. Build with
+ *
+ *  make main INSTRUMENT=1        (adds -DLAMBDA_INSTRUMENT)
+ *
+ *  to turn them on. Use as follows:
+ *
+ *  PROFILE_MEMBER(profile);              // in the class
+ *  PROFILE_START(t);                     // at the start of a step
+ *  ... scale factor ...
+ *  PROFILE_PHASE(profile, SCALE, t);     // cycles since t go to SCALE
+ *  PROFILE_COUNT(profile, breaks);
+ *  PROFILE_SUBMIT(profile);              // at the end of a run
+ *
+ *  Without LAMBDA_INSTRUMENT all macros expand to nothing, so the
+ *  hot path is the same code as without them. With it, every phase
+ *  reads the time stamp counter (about 20 cycles, included in the
+ *  numbers). Every run adds its counters to a process total under a
+ *  lock, and the total is printed at exit as cycles per step and
+ *  share of each phase, with the number of runs that stopped early
+ *  because the root became negative.
+ *
+ *----------------------------------------------------------------*/
+
+#pragma once
+
+#ifdef LAMBDA_INSTRUMENT
+
+#include <stdio.h>
+#include <stdint.h>
+#include <mutex>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+struct StepProfile {
+    enum Phase { SCALE, VOLUME, RNG, UPDATE, SINK, PHASES };
+
+    uint64_t cycles[PHASES];
+    uint64_t steps;
+    uint64_t runs;
+    uint64_t breaks;    // runs stopped because root < 0
+
+    StepProfile() {
+        clear();
+    }
+
+    void clear() {
+        for (int k = 0; k < PHASES; k++) {
+            cycles[k] = 0;
+        }
+        steps = 0;
+        runs = 0;
+        breaks = 0;
+    }
+
+    void merge(const StepProfile &other) {
+        for (int k = 0; k < PHASES; k++) {
+            cycles[k] += other.cycles[k];
+        }
+        steps += other.steps;
+        runs += other.runs;
+        breaks += other.breaks;
+    }
+
+    // time stamp counter, or nanoseconds where there is none
+    static inline uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    // add p to the process total and clear it
+    static void submit(StepProfile &p);
+
+    void print(FILE* ofp) const {
+        static const char* names[PHASES] = { "scale factor", "volume", "rng draw", "lambda/rho", "sink" };
+        uint64_t sum = 0;
+        for (int k = 0; k < PHASES; k++) {
+            sum += cycles[k];
+        }
+        fprintf(ofp, "Step profile: %llu steps in %llu runs, %llu stopped early (root < 0)\n",
+                (unsigned long long) steps, (unsigned long long) runs, (unsigned long long) breaks);
+        fprintf(ofp, "%-16s%14s%10s\n", "phase", "cycles/step", "share");
+        for (int k = 0; k < PHASES; k++) {
+            fprintf(ofp, "%-16s%14.1f%9.1f%%\n", names[k],
+                    steps ? (double) cycles[k] / steps : 0.0, sum ? 100.0 * cycles[k] / sum : 0.0);
+        }
+        fprintf(ofp, "%-16s%14.1f\n", "total", steps ? (double) sum / steps : 0.0);
+    }
+};
+
+// Process total of all runs, printed at exit
+struct StepProfileRegistry {
+    std::mutex lock;
+    StepProfile total;
+
+    ~StepProfileRegistry() {
+        if (total.runs > 0) {
+            total.print(stdout);
+        }
+    }
+
+    static StepProfileRegistry& instance() {
+        static StepProfileRegistry r;
+        return r;
+    }
+};
+
+inline void StepProfile::submit(StepProfile &p) {
+    StepProfileRegistry &r = StepProfileRegistry::instance();
+    std::lock_guard<std::mutex> guard(r.lock);
+    r.total.merge(p);
+    p.clear();
+}
+
+#define PROFILE_MEMBER(p)        StepProfile p
+#define PROFILE_START(t)         uint64_t t = StepProfile::now()
+#define PROFILE_PHASE(p, ph, t)  do { uint64_t t##_ = StepProfile::now(); (p).cycles[StepProfile::ph] += t##_ - t; t = t##_; } while (0)
+#define PROFILE_COUNT(p, c)      ((p).c++)
+#define PROFILE_SUBMIT(p)        StepProfile::submit(p)
+
+#else
+
+#define PROFILE_MEMBER(p)
+#define PROFILE_START(t)
+#define PROFILE_PHASE(p, ph, t)  do { } while (0)
+#define PROFILE_COUNT(p, c)      do { } while (0)
+#define PROFILE_SUBMIT(p)        do { } while (0)
+
+#endif
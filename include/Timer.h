@@ -1,7 +1,7 @@
 /*----------------------------------------------------------------
  *
  * 	Written:       10/10/2013
- *  Last updated:  10/10/2013
+ *  Last updated:  17/10/2026
  *
  *
  *  This is a custom stopwatch. Use as follows:
@@ -10,47 +10,504 @@
  *  // stuff you want to time
  *  myTimer.stop();
  *
+ *  It measures wall time with steady_clock and the CPU time of the
+ *  calling thread (CLOCK_THREAD_CPUTIME_ID); std::clock() would sum
+ *  the CPU time of all threads.
+ *
+ *  For a profile, put a region in the scopes of interest:
+ *
+ *  {
+ *      TimerRegion region("runSimulation");
+ *      ...
+ *  }
+ *
+ *  Regions nest into a tree per thread. When a thread ends its tree
+ *  is merged by path into one for the process, and at exit this is
+ *  printed with calls, total, mean and max wall time, CPU time and
+ *  the number of threads of every region. Timer::report() prints it
+ *  earlier. A region costs a few clock reads, so put it around
+ *  whole runs or phases, not single steps.
+ *
+ *  After Timer::enableCounters() every thread also opens Linux
+ *  hardware counters (perf_event_open: cycles, instructions, last
+ *  level cache misses and branch misses of the thread, user space
+ *  only) and each region adds up their change. The report then has
+ *  these columns too. Where the kernel does not allow it (see
+ *  /proc/sys/kernel/perf_event_paranoid) or there is no PMU, as in
+ *  many VMs, the columns are left out and the report says why.
+ *
+ *  After Timer::enableTrace("trace.json") every region also records
+ *  a begin and an end event with its time stamp into a buffer of its
+ *  own thread, which needs no lock. At exit all buffers are written
+ *  as Chrome trace-event JSON, which chrome://tracing and the
+ *  Perfetto UI open as a timeline with one track per thread. Tracing
+ *  is off by default; when on it costs one push_back per event and
+ *  keeps at most MAX_EVENTS events per thread; a region only records
+ *  its begin while there is room left for its end and those of the
+ *  regions around it, so the trace stays balanced. Region names must be
+ *  string literals, the trace keeps only the pointer.
+ *
  *----------------------------------------------------------------*/
 
 #pragma once
 
-#include <ctime>
+#include <stdio.h>
+#include <time.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#include <atomic>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <sstream>
+#include <vector>
+
+// Node of a region tree: totals of all calls of one region under one parent
+struct TimerNode {
+	// hardware counters: cycles, instructions, LLC misses, branch misses
+	static const int COUNTERS = 4;
+
+	std::string name;
+	long long calls;
+	long long threads;      // threads that entered the region
+	double wall;            // seconds
+	double wallmax;
+	double cpu;             // seconds of thread CPU time
+	long long counted;      // calls with hardware counters
+	uint64_t counters[COUNTERS];
+	std::vector<std::unique_ptr<TimerNode> > children;
+
+	TimerNode(const std::string &name) : name(name), calls(0), threads(0), wall(0.0), wallmax(0.0), cpu(0.0), counted(0) {
+		for (int k = 0; k < COUNTERS; k++) {
+			counters[k] = 0;
+		}
+	}
+
+	// child with the given name, created if new
+	TimerNode* child(const char* childname) {
+		for (size_t k = 0; k < children.size(); k++) {
+			if (children[k]->name == childname) return children[k].get();
+		}
+		children.push_back(std::unique_ptr<TimerNode>(new TimerNode(childname)));
+		return children.back().get();
+	}
+
+	// add the totals of other and its subtree
+	void merge(const TimerNode &other) {
+		calls += other.calls;
+		threads += other.threads;
+		wall += other.wall;
+		cpu += other.cpu;
+		counted += other.counted;
+		for (int k = 0; k < COUNTERS; k++) {
+			counters[k] += other.counters[k];
+		}
+		if (other.wallmax > wallmax) wallmax = other.wallmax;
+		for (size_t k = 0; k < other.children.size(); k++) {
+			child(other.children[k]->name.c_str())->merge(*other.children[k]);
+		}
+	}
+};
+
+
+// Begin or end of a region, for the trace
+struct TraceEvent {
+	const char* name;
+	int64_t ns;             // steady_clock nanoseconds
+	char phase;             // 'B' or 'E'
+};
 
 
 class Timer {
 
+	friend class TimerRegion;
+
+	static const size_t MAX_EVENTS = 1 << 20;   // trace events kept per thread
+
 private:
-	std::clock_t start;
+	std::chrono::steady_clock::time_point start;
+	double cpustart;
 	std::string name;
 
+	// Region trees of finished threads, printed at exit
+	struct Registry {
+		std::mutex lock;
+		TimerNode total;
+		std::atomic<bool> counters;     // open hardware counters in new threads
+		std::atomic<int> countererror;  // errno of the first failed perf_event_open
+		std::atomic<bool> tracing;      // record trace events
+		std::string tracefile;
+		std::atomic<int> threads;       // trace ids handed out
+		std::vector<std::pair<int, std::vector<TraceEvent> > > events;  // of finished threads
+		uint64_t dropped;               // events beyond MAX_EVENTS
+
+		Registry() : total("total"), counters(false), countererror(0), tracing(false), threads(0), dropped(0) {
+		}
+
+		~Registry() {
+			if (tracing) {
+				writeTrace(*this);
+			}
+			if (!total.children.empty()) {
+				print(std::cout, total);
+			}
+		}
+	};
+
+	// Region tree of the calling thread
+	struct ThreadTree {
+		TimerNode root;
+		std::vector<TimerNode*> stack;     // open regions, innermost last
+		int fds[TimerNode::COUNTERS];      // hardware counter group, fds[0] leads
+		bool opened;                       // tried to open the counters
+		int tid;                           // thread id in the trace
+		std::vector<TraceEvent> events;    // trace of this thread, only written by it
+		size_t open;                       // recorded begins still waiting for their end
+		size_t skipped;                    // open regions whose begin was dropped
+		uint64_t dropped;
+
+		ThreadTree() : root("total"), opened(false), open(0), skipped(0), dropped(0) {
+			Registry &r = registry();      // constructed first, so it outlives this
+			tid = r.threads++;
+			stack.push_back(&root);
+			for (int k = 0; k < TimerNode::COUNTERS; k++) {
+				fds[k] = -1;
+			}
+		}
+
+		~ThreadTree() {
+			for (int k = 0; k < TimerNode::COUNTERS; k++) {
+				if (fds[k] >= 0) close(fds[k]);
+			}
+			Registry &r = registry();
+			std::lock_guard<std::mutex> guard(r.lock);
+			r.total.merge(root);
+			if (!events.empty()) {
+				r.events.push_back(std::make_pair(tid, std::vector<TraceEvent>()));
+				r.events.back().second.swap(events);
+			}
+			r.dropped += dropped;
+		}
+
+		void trace(const char* name, char phase, std::chrono::steady_clock::time_point t) {
+			// events.size() + open never shrinks, so once a begin is dropped
+			// every region inside it is too, and the next ends are theirs
+			if (phase == 'B' && (skipped > 0 || events.size() + open + 2 > MAX_EVENTS)) {
+				skipped++;
+				dropped++;
+				return;
+			}
+			if (phase == 'E' && skipped > 0) {
+				skipped--;
+				dropped++;
+				return;
+			}
+			if (phase == 'B') {
+				open++;
+			} else if (open > 0) {
+				open--;
+			}
+			if (events.capacity() == 0) events.reserve(4096);
+			TraceEvent e = { name, std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count(), phase };
+			events.push_back(e);
+		}
+
+		// current counter values of this thread, false if there are none
+		bool readCounters(uint64_t values[TimerNode::COUNTERS]) {
+			if (!registry().counters.load(std::memory_order_relaxed)) return false;
+			if (!opened) {
+				opened = true;
+				openCounters(fds);
+			}
+			if (fds[0] < 0) return false;
+			uint64_t buffer[1 + TimerNode::COUNTERS];   // nr, then one value per counter
+			if (read(fds[0], buffer, sizeof(buffer)) != (ssize_t) sizeof(buffer)) return false;
+			for (int k = 0; k < TimerNode::COUNTERS; k++) {
+				values[k] = buffer[1 + k];
+			}
+			return true;
+		}
+	};
+
+	// Open the counters of the calling thread as one group; all fds -1 on failure
+	static void openCounters(int fds[TimerNode::COUNTERS]) {
+#ifdef __linux__
+		static const uint64_t configs[TimerNode::COUNTERS] = {
+			PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+		};
+		for (int k = 0; k < TimerNode::COUNTERS; k++) {
+			struct perf_event_attr attr;
+			memset(&attr, 0, sizeof(attr));
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.size = sizeof(attr);
+			attr.config = configs[k];
+			attr.disabled = k == 0;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP;
+			fds[k] = (int) syscall(__NR_perf_event_open, &attr, 0, -1, k == 0 ? -1 : fds[0], 0);
+			if (fds[k] < 0) {
+				int expected = 0;
+				registry().countererror.compare_exchange_strong(expected, errno);
+				for (int j = 0; j < k; j++) {
+					close(fds[j]);
+					fds[j] = -1;
+				}
+				return;
+			}
+		}
+		ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+		int expected = 0;
+		registry().countererror.compare_exchange_strong(expected, ENOSYS);
+		for (int k = 0; k < TimerNode::COUNTERS; k++) {
+			fds[k] = -1;
+		}
+#endif
+	}
+
+	static void printNode(std::ostream &os, const TimerNode &node, int depth, bool counters) {
+		std::string label = std::string(2 * depth, ' ') + node.name;
+		os << std::left << std::setw(32) << label << std::right
+		   << std::setw(10) << node.calls
+		   << std::setw(12) << node.wall
+		   << std::setw(12) << node.wall / node.calls
+		   << std::setw(12) << node.wallmax
+		   << std::setw(12) << node.cpu
+		   << std::setw(8) << node.threads;
+		if (counters) {
+			for (int k = 0; k < TimerNode::COUNTERS; k++) {
+				os << std::setw(12) << (double) node.counters[k];
+			}
+			os << std::setw(8) << std::fixed << std::setprecision(2)
+			   << (node.counters[0] ? (double) node.counters[1] / node.counters[0] : 0.0)
+			   << std::scientific << std::setprecision(3);
+		}
+		os << "\n";
+		for (size_t k = 0; k < node.children.size(); k++) {
+			printNode(os, *node.children[k], depth + 1, counters);
+		}
+	}
+
+	// Write the events of all finished threads as Chrome trace-event JSON
+	static void writeTrace(Registry &r) {
+		FILE *ofp = fopen(r.tracefile.c_str(), "w");
+
+		if (ofp == NULL) {
+		  fprintf(stderr, "Can't open output file %s!\n",
+		          r.tracefile.c_str());
+		  return;
+		}
+
+		// time stamps relative to the first event, in microseconds
+		int64_t t0 = INT64_MAX;
+		for (size_t k = 0; k < r.events.size(); k++) {
+			if (!r.events[k].second.empty() && r.events[k].second[0].ns < t0) t0 = r.events[k].second[0].ns;
+		}
+		fprintf(ofp, "{\"traceEvents\":[\n");
+		bool first = true;
+		for (size_t k = 0; k < r.events.size(); k++) {
+			int tid = r.events[k].first;
+			fprintf(ofp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+			        first ? "" : ",\n", tid, tid);
+			first = false;
+			const std::vector<TraceEvent> &events = r.events[k].second;
+			for (size_t i = 0; i < events.size(); i++) {
+				fprintf(ofp, ",\n{\"name\":\"");
+				for (const char* c = events[i].name; *c; c++) {
+					if (*c == '"' || *c == '\\') fputc('\\', ofp);
+					fputc(*c, ofp);
+				}
+				fprintf(ofp, "\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}",
+				        events[i].phase, (events[i].ns - t0) / 1000.0, tid);
+			}
+		}
+		fprintf(ofp, "\n],\"displayTimeUnit\":\"ns\"}\n");
+		fclose(ofp);
+		if (r.dropped > 0) {
+			fprintf(stderr, "Trace: dropped %llu events beyond %llu per thread\n",
+			        (unsigned long long) r.dropped, (unsigned long long) MAX_EVENTS);
+		}
+	}
+
+	static bool hasCounters(const TimerNode &node) {
+		if (node.counted > 0) return true;
+		for (size_t k = 0; k < node.children.size(); k++) {
+			if (hasCounters(*node.children[k])) return true;
+		}
+		return false;
+	}
+
+	static void print(std::ostream &os, const TimerNode &total) {
+		std::ios::fmtflags flags = os.flags();
+		bool counters = hasCounters(total);
+		os << "Timer report (seconds; cpu is thread CPU time)\n";
+		os << std::left << std::setw(32) << "region" << std::right
+		   << std::setw(10) << "calls"
+		   << std::setw(12) << "total"
+		   << std::setw(12) << "mean"
+		   << std::setw(12) << "max"
+		   << std::setw(12) << "cpu"
+		   << std::setw(8) << "threads";
+		if (counters) {
+			os << std::setw(12) << "cycles"
+			   << std::setw(12) << "instr"
+			   << std::setw(12) << "llc-miss"
+			   << std::setw(12) << "br-miss"
+			   << std::setw(8) << "ipc";
+		}
+		os << "\n";
+		os << std::scientific << std::setprecision(3);
+		for (size_t k = 0; k < total.children.size(); k++) {
+			printNode(os, *total.children[k], 0, counters);
+		}
+		int error = registry().countererror.load();
+		if (error != 0) {
+			os << "Hardware counters unavailable (perf_event_open: " << strerror(error) << ")\n";
+		}
+		os.flush();
+		os.flags(flags);
+	}
+
 public:
 	Timer(const char* timername) {
-		start = std::clock();
+		reset();
 		name = timername;
 		std::cout << "Starting the process \"" << name << "\"." << std::endl;
 	}
 
 	//  resets the timer to the current time
 	void reset() {
-	    start = std::clock();
+		start = std::chrono::steady_clock::now();
+		cpustart = cpuTime();
+	}
+
+	//  wall time in seconds since instantiation or reset
+	double elapsed() const {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	//  CPU time of the calling thread in seconds since instantiation or reset
+	double elapsedCpu() const {
+		return cpuTime() - cpustart;
 	}
 
 	//  records time taken since instantiation and
 	//  prints it out to the console
 	void stop() {
 		std::cout.flush();
-		double t = (std::clock() - this->start) / (double) CLOCKS_PER_SEC;
+		double t = elapsed();
 		std::cout << "The process \"" << name << "\" took " << t << " seconds." << std::endl;
 	};
 
     std::string toString() {
         std::ostringstream ss;
-        ss << (std::clock() - this->start) / (double) CLOCKS_PER_SEC;
+        ss << elapsed();
         return ss.str();
     };
 
+	// open hardware counters in every thread that enters a region from now on
+	static void enableCounters() {
+		registry().counters = true;
+	}
+
+	// record begin and end of every region from now on; written to filename at exit
+	static void enableTrace(const char* filename) {
+		Registry &r = registry();
+		{
+			std::lock_guard<std::mutex> guard(r.lock);
+			r.tracefile = filename;
+		}
+		r.tracing = true;
+	}
+
+	// CPU time of the calling thread in seconds
+	static double cpuTime() {
+		struct timespec ts;
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+		return ts.tv_sec + 1e-9 * ts.tv_nsec;
+	}
+
+	static Registry& registry() {
+		static Registry r;
+		return r;
+	}
+
+	static ThreadTree& tree() {
+		thread_local ThreadTree t;
+		return t;
+	}
+
+	// print the regions of finished threads and of the calling thread
+	static void report(std::ostream &os = std::cout) {
+		Registry &r = registry();
+		TimerNode total("total");
+		{
+			std::lock_guard<std::mutex> guard(r.lock);
+			total.merge(r.total);
+		}
+		total.merge(tree().root);
+		print(os, total);
+	}
+};
+
+
+// Scoped region of the calling thread's tree, timed from construction to destruction
+class TimerRegion {
+
+private:
+	TimerNode* node;
+	std::chrono::steady_clock::time_point start;
+	double cpustart;
+	bool counted;
+	bool traced;
+	uint64_t counterstart[TimerNode::COUNTERS];
+	const char* name;
+
+	TimerRegion(const TimerRegion&);
+	TimerRegion& operator=(const TimerRegion&);
+
+public:
+	TimerRegion(const char* name) : name(name) {
+		Timer::ThreadTree &tree = Timer::tree();
+		node = tree.stack.back()->child(name);
+		tree.stack.push_back(node);
+		counted = tree.readCounters(counterstart);
+		traced = Timer::registry().tracing.load(std::memory_order_relaxed);
+		cpustart = Timer::cpuTime();
+		start = std::chrono::steady_clock::now();
+		if (traced) tree.trace(name, 'B', start);
+	}
+
+	~TimerRegion() {
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+		double wall = std::chrono::duration<double>(end - start).count();
+		double cpu = Timer::cpuTime() - cpustart;
+		Timer::ThreadTree &tree = Timer::tree();
+		if (traced) tree.trace(name, 'E', end);
+		uint64_t counterend[TimerNode::COUNTERS];
+		if (counted && tree.readCounters(counterend)) {
+			node->counted++;
+			for (int k = 0; k < TimerNode::COUNTERS; k++) {
+				node->counters[k] += counterend[k] - counterstart[k];
+			}
+		}
+		if (node->calls++ == 0) node->threads = 1;
+		node->wall += wall;
+		node->cpu += cpu;
+		if (wall > node->wallmax) node->wallmax = wall;
+		tree.stack.pop_back();
+	}
 };
@@ -0,0 +1,292 @@
+/*----------------------------------------------------------------
+ *
+ *  Written:       17/10/2026
+ *  Last updated:  17/10/2026
+ *
+ *
+ *  State of one step of the Simulator, its parameters and an
+ *  in-memory record of all steps. Use as follows:
+ *
+ *  Trajectory trajectory(steps);
+ *  simulator.runSimulation(trajectory);
+ *  const double* lambda = trajectory.getLambda();
+ *
+ *  Any class with a method record(int i, const SimulatorState &s)
+ *  can be passed to runSimulation; it is called once for step 0 and
+ *  once after every step. Trajectory keeps everything (9 doubles per
+ *  step), TrajectoryWriter only a fixed-size chunk.
+ *
+ *  Which columns are kept is a compile-time policy: Trajectory is
+ *  TrajectoryOf<AllColumns>. A policy says for every column whether
+ *  it is STORED, IMPLICIT (tau = tau0 + i * deltatau, from the step
+ *  index), COMPUTED from a stored column (N from V, rhomat and rhorad
+ *  from a, by the expressions of Simulator::doStep, so the values are
+ *  the same) or DROPPED:
+ *
+ *  TrajectoryOf<LambdaColumns> trajectory(steps, simulator.getParameters());
+ *  simulator.runSimulation(trajectory);
+ *  double lambda = trajectory.getLambda(i);
+ *  double tau = trajectory.getTau(i);
+ *
+ *  record() then writes 1 double per step instead of 9. getX(i)
+ *  works for every column that is not dropped, getX() (the array)
+ *  only for stored ones; asking for anything else does not compile.
+ *
+ *  The columns come from an Arena, 64-byte aligned: the Trajectory's
+ *  own, or one passed in, Trajectory(steps, arena), in which case
+ *  they live until the arena is reset.
+ *
+ *----------------------------------------------------------------*/
+
+#pragma once
+
+#include <stdlib.h>
+#include <math.h>
+#include "Arena.h"
+
+// Everything the recurrence needs to go from step i to step i + 1
+struct SimulatorState {
+    double tau;         // proper time (along isotropic worldlines)
+    double a;           // scale factor
+    double N;           // number of atoms
+    double V;           // volume
+    double S;           // action
+    double rhomat;      // matter energy density
+    double rhorad;      // radiation energy density
+    double lambda;      // lambda
+    double eta;         // conformal time sum_{k<i}(dt/a)
+};
+
+// Initial conditions and model parameters of a run
+struct SimulatorParameters {
+    int seed;
+    int run;
+    double a0;          // initial scale factor
+    double tau0;        // initial time
+    double deltatau;    // time increment
+    double V0;          // initial volume
+    double rhomat0;     // initial matter energy density
+    double rhorad0;     // initial radiation energy density
+    double lambda0;     // initial dark energy density
+    double ell;         // free parameter ell
+};
+
+// How a trajectory keeps a column
+enum ColumnPolicy {
+    DROPPED,            // not kept
+    STORED,             // one double per step
+    IMPLICIT,           // from the step index (tau only)
+    COMPUTED            // from another stored column (N, rhomat, rhorad)
+};
+
+// Every column stored
+struct AllColumns {
+    static const int tau = STORED;
+    static const int a = STORED;
+    static const int N = STORED;
+    static const int V = STORED;
+    static const int S = STORED;
+    static const int rhomat = STORED;
+    static const int rhorad = STORED;
+    static const int lambda = STORED;
+    static const int eta = STORED;
+};
+
+// Same values as AllColumns from 5 stored columns
+struct CompactColumns {
+    static const int tau = IMPLICIT;
+    static const int a = STORED;
+    static const int N = COMPUTED;
+    static const int V = STORED;
+    static const int S = STORED;
+    static const int rhomat = COMPUTED;
+    static const int rhorad = COMPUTED;
+    static const int lambda = STORED;
+    static const int eta = STORED;
+};
+
+// tau and lambda, all that lambda.txt needs, from 1 stored column
+struct LambdaColumns {
+    static const int tau = IMPLICIT;
+    static const int a = DROPPED;
+    static const int N = DROPPED;
+    static const int V = DROPPED;
+    static const int S = DROPPED;
+    static const int rhomat = DROPPED;
+    static const int rhorad = DROPPED;
+    static const int lambda = STORED;
+    static const int eta = DROPPED;
+};
+
+template <class Columns>
+class TrajectoryOf {
+
+    static_assert(Columns::tau != COMPUTED, "tau can be stored, implicit or dropped");
+    static_assert(Columns::N != IMPLICIT && (Columns::N != COMPUTED || Columns::V == STORED),
+                  "N can only be computed from a stored V");
+    static_assert(Columns::rhomat != IMPLICIT && (Columns::rhomat != COMPUTED || Columns::a == STORED),
+                  "rhomat can only be computed from a stored a");
+    static_assert(Columns::rhorad != IMPLICIT && (Columns::rhorad != COMPUTED || Columns::a == STORED),
+                  "rhorad can only be computed from a stored a");
+    static_assert((Columns::a == STORED || Columns::a == DROPPED) && (Columns::V == STORED || Columns::V == DROPPED) &&
+                  (Columns::S == STORED || Columns::S == DROPPED) && (Columns::lambda == STORED || Columns::lambda == DROPPED) &&
+                  (Columns::eta == STORED || Columns::eta == DROPPED),
+                  "a, V, S, lambda and eta can only be stored or dropped");
+
+private:
+    int steps;
+    int last;           // last step recorded, -1 if none
+    SimulatorParameters p;  // for the implicit and computed columns
+
+    // NULL unless stored
+    double* tau;
+    double* a;
+    double* N;
+    double* V;
+    double* S;
+    double* rhomat;
+    double* rhorad;
+    double* lambda;
+    double* eta;
+
+    // holds the arrays unless they come from another arena
+    Arena own;
+
+    TrajectoryOf(const TrajectoryOf&);
+    TrajectoryOf& operator=(const TrajectoryOf&);
+
+public:
+    // number of stored columns
+    static const int COLUMNS = (Columns::tau == STORED) + (Columns::a == STORED) + (Columns::N == STORED) +
+                               (Columns::V == STORED) + (Columns::S == STORED) + (Columns::rhomat == STORED) +
+                               (Columns::rhorad == STORED) + (Columns::lambda == STORED) + (Columns::eta == STORED);
+
+    // only for policies that store everything they keep
+    TrajectoryOf(int steps) {
+        static_assert(COLUMNS == 9, "implicit and computed columns need the SimulatorParameters");
+        own.reserve(bytes(steps));
+        allocate(steps, own);
+    }
+
+    // arrays from arena, valid until it is reset
+    TrajectoryOf(int steps, Arena &arena) {
+        static_assert(COLUMNS == 9, "implicit and computed columns need the SimulatorParameters");
+        allocate(steps, arena);
+    }
+
+    // p: parameters of the run, for the implicit and computed columns
+    TrajectoryOf(int steps, const SimulatorParameters &p) : p(p) {
+        own.reserve(bytes(steps));
+        allocate(steps, own);
+    }
+
+    TrajectoryOf(int steps, Arena &arena, const SimulatorParameters &p) : p(p) {
+        allocate(steps, arena);
+    }
+
+    // arena bytes of the arrays for steps steps
+    static size_t bytes(int steps) {
+        return COLUMNS * Arena::aligned(steps * sizeof(double));
+    }
+
+    void record(int i, const SimulatorState &s) {
+        if (Columns::tau == STORED)    tau[i] = s.tau;
+        if (Columns::a == STORED)      a[i] = s.a;
+        if (Columns::N == STORED)      N[i] = s.N;
+        if (Columns::V == STORED)      V[i] = s.V;
+        if (Columns::S == STORED)      S[i] = s.S;
+        if (Columns::rhomat == STORED) rhomat[i] = s.rhomat;
+        if (Columns::rhorad == STORED) rhorad[i] = s.rhorad;
+        if (Columns::lambda == STORED) lambda[i] = s.lambda;
+        if (Columns::eta == STORED)    eta[i] = s.eta;
+        last = i;
+    }
+
+private:
+    static double* column(int policy, int steps, Arena &arena) {
+        return policy == STORED ? arena.allocate<double>(steps) : NULL;
+    }
+
+    void allocate(int steps, Arena &arena) {
+        this->steps = steps;
+        this->last = -1;
+        tau =    column(Columns::tau, steps, arena);
+        a =      column(Columns::a, steps, arena);
+        N =      column(Columns::N, steps, arena);
+        V =      column(Columns::V, steps, arena);
+        S =      column(Columns::S, steps, arena);
+        rhomat = column(Columns::rhomat, steps, arena);
+        rhorad = column(Columns::rhorad, steps, arena);
+        lambda = column(Columns::lambda, steps, arena);
+        eta =    column(Columns::eta, steps, arena);
+    }
+
+public:
+    int getSteps() const {
+        return steps;
+    }
+
+    int getLastStep() const {
+        return last;
+    }
+
+    // value of step i, unless dropped
+    double getTau(int i) const {
+        static_assert(Columns::tau != DROPPED, "tau is dropped");
+        return Columns::tau == STORED ? tau[i] : p.tau0 + i * p.deltatau;
+    }
+
+    double getA(int i) const {
+        static_assert(Columns::a != DROPPED, "a is dropped");
+        return a[i];
+    }
+
+    double getN(int i) const {
+        static_assert(Columns::N != DROPPED, "N is dropped");
+        return Columns::N == STORED ? N[i] : V[i] / pow(p.ell, 4.0);
+    }
+
+    double getV(int i) const {
+        static_assert(Columns::V != DROPPED, "V is dropped");
+        return V[i];
+    }
+
+    double getS(int i) const {
+        static_assert(Columns::S != DROPPED, "S is dropped");
+        return S[i];
+    }
+
+    double getRhomat(int i) const {
+        static_assert(Columns::rhomat != DROPPED, "rhomat is dropped");
+        return Columns::rhomat == STORED ? rhomat[i] : p.rhomat0 * pow(p.a0 / a[i], 3.0);
+    }
+
+    double getRhorad(int i) const {
+        static_assert(Columns::rhorad != DROPPED, "rhorad is dropped");
+        return Columns::rhorad == STORED ? rhorad[i] : p.rhorad0 * pow(p.a0 / a[i], 4.0);
+    }
+
+    double getLambda(int i) const {
+        static_assert(Columns::lambda != DROPPED, "lambda is dropped");
+        return lambda[i];
+    }
+
+    double getEta(int i) const {
+        static_assert(Columns::eta != DROPPED, "eta is dropped");
+        return eta[i];
+    }
+
+    // arrays of the stored columns
+    const double* getTau() const    { static_assert(Columns::tau == STORED, "tau is not stored"); return tau; }
+    const double* getA() const      { static_assert(Columns::a == STORED, "a is not stored"); return a; }
+    const double* getN() const      { static_assert(Columns::N == STORED, "N is not stored"); return N; }
+    const double* getV() const      { static_assert(Columns::V == STORED, "V is not stored"); return V; }
+    const double* getS() const      { static_assert(Columns::S == STORED, "S is not stored"); return S; }
+    const double* getRhomat() const { static_assert(Columns::rhomat == STORED, "rhomat is not stored"); return rhomat; }
+    const double* getRhorad() const { static_assert(Columns::rhorad == STORED, "rhorad is not stored"); return rhorad; }
+    const double* getLambda() const { static_assert(Columns::lambda == STORED, "lambda is not stored"); return lambda; }
+    const double* getEta() const    { static_assert(Columns::eta == STORED, "eta is not stored"); return eta; }
+};
+
+// all columns, as the Simulator keeps by default
+typedef TrajectoryOf<AllColumns> Trajectory;
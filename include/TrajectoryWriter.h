@@ -0,0 +1,87 @@
+/*----------------------------------------------------------------
+ *
+ *  Written:       17/10/2026
+ *  Last updated:  17/10/2026
+ *
+ *
+ *  Streams the steps of a Simulator to a text file in chunks of
+ *  fixed size. Use as follows:
+ *
+ *  TrajectoryWriter writer("trajectory.txt", chunk);
+ *  simulator.runSimulation(writer);
+ *  writer.close();
+ *
+ *  Only one chunk of states is held in memory, so the footprint does
+ *  not depend on the number of steps. Every full chunk is written and
+ *  flushed straight away; if the run dies, all completed chunks are
+ *  already on disk. Columns:
+ *
+ *  tau lambda a N V S rhomat rhorad eta
+ *
+ *----------------------------------------------------------------*/
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "Trajectory.h"
+
+class TrajectoryWriter {
+
+private:
+    FILE* ofp;
+    SimulatorState* chunk;
+    int size;           // capacity of chunk
+    int count;          // states waiting in chunk
+
+    TrajectoryWriter(const TrajectoryWriter&);
+    TrajectoryWriter& operator=(const TrajectoryWriter&);
+
+public:
+    TrajectoryWriter(const char* outputFilename, int size) {
+        ofp = fopen(outputFilename, "w");
+
+        if (ofp == NULL) {
+          fprintf(stderr, "Can't open output file %s!\n",
+                  outputFilename);
+          exit(1);
+        }
+
+        this->size = size > 0 ? size : 1;
+        this->count = 0;
+        chunk = new SimulatorState[this->size];
+        fprintf(ofp, "# tau\tlambda\ta\tN\tV\tS\trhomat\trhorad\teta\n");
+    }
+
+    ~TrajectoryWriter() {
+        close();
+        delete[] chunk;
+    }
+
+    void record(int i, const SimulatorState &s) {
+        chunk[count++] = s;
+        if (count == size) {
+            flush();
+        }
+    }
+
+    /* write the states held so far and push them to disk */
+    void flush() {
+        if (ofp == NULL) return;
+        for (int k = 0; k < count; k++) {
+            const SimulatorState &s = chunk[k];
+            fprintf(ofp, "%E\t%E\t%E\t%E\t%E\t%E\t%E\t%E\t%E\n",
+                    s.tau, s.lambda, s.a, s.N, s.V, s.S, s.rhomat, s.rhorad, s.eta);
+        }
+        count = 0;
+        fflush(ofp);
+    }
+
+    /* write the last partial chunk and close the file */
+    void close() {
+        if (ofp == NULL) return;
+        flush();
+        fclose(ofp);
+        ofp = NULL;
+    }
+};
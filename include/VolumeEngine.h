@@ -0,0 +1,91 @@
+/*----------------------------------------------------------------
+ *
+ *  Written:       17/10/2026
+ *  Last updated:  17/10/2026
+ *
+ *
+ *  This is an incremental volume engine. Use as follows:
+ *
+ *  VolumeEngine engine;
+ *  for each step i:
+ *      double v = engine.push(a[i], tau[i + 1] - tau[i]);
+ *
+ *  After step i the simulator needs
+ *
+ *  v = sum_{k<=i} (a[k] * y[k])^3 * dt[k],
+ *
+ *  where every y[k] has received the same increment d = dt[i] / a[i].
+ *  Instead of looping over k, the engine keeps the moments
+ *
+ *  m_j = sum_{k<=i} a[k]^3 * dt[k] * y[k]^j,    j = 0..3
+ *
+ *  and shifts them binomially when all y[k] grow by d:
+ *
+ *  m3 += 3 d m2 + 3 d^2 m1 + d^3 m0
+ *  m2 += 2 d m1 + d^2 m0
+ *  m1 += d m0
+ *
+ *  Every term is positive, so there is no cancellation and each
+ *  step costs O(1) instead of O(i).
+ *
+ *----------------------------------------------------------------*/
+
+#pragma once
+
+class VolumeEngine {
+
+private:
+    /* m[j] = sum_k a_k^3 dt_k y_k^j */
+    double m0;
+    double m1;
+    double m2;
+    double m3;
+    /* conformal time sum_k dt_k / a_k accumulated so far */
+    double eta;
+
+public:
+    VolumeEngine() {
+        reset();
+    }
+
+    /* forget all previous steps */
+    void reset() {
+        m0 = 0.0;
+        m1 = 0.0;
+        m2 = 0.0;
+        m3 = 0.0;
+        eta = 0.0;
+    }
+
+    /*  Add step with scale factor a and time increment dt. Returns the
+     *  updated sum_k (a_k y_k)^3 dt_k, without the prefactor c^4 4 pi / 3. */
+    double push(double a, double dt) {
+        double d = dt / a;
+        double d2 = d * d;
+
+        // shift existing moments (m3 first, it needs the old m2, m1)
+        m3 += 3.0 * d * m2 + 3.0 * d2 * m1 + d2 * d * m0;
+        m2 += 2.0 * d * m1 + d2 * m0;
+        m1 += d * m0;
+
+        // new term k = i with y_i = d
+        double w = a * a * a * dt;
+        m0 += w;
+        m1 += w * d;
+        m2 += w * d2;
+        m3 += w * d2 * d;
+
+        eta += d;
+        return m3;
+    }
+
+    /* current value of sum_k (a_k y_k)^3 dt_k */
+    double getSum() const {
+        return m3;
+    }
+
+    /* conformal time sum_k dt_k / a_k; y[k] = getConformalTime() - (value before step k) */
+    double getConformalTime() const {
+        return eta;
+    }
+};
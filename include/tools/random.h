@@ -3,20 +3,56 @@
 
 #include <vector>
 #include <string>
+#include <math.h>
+#include "../../lib/randomc/randomc.h"
+#include "../../lib/randomc/philox.h"
+#include "../../lib/randomc/sfmt.h"
 
-// Current Time Seeder
-void InitRandom();
-
-// Integer Seeder
-void InitRandom(int seed);
+// The generator is passed in explicitly: every Simulator owns its own,
+// so concurrent runs never share random state. The helpers are templates
+// on the generator type (CRandomMersenne, CRandomMother, CRandomSFMT or
+// CRandomPhilox), so the choice is made at compile time and each call
+// is direct.
 
 // Return a uniform double in (0,1)
-double rnd();
+template<class RNG> inline double rnd(RNG &gen) {
+    return gen.Random();
+}
 
 // Get random gaussian with mean mu and s.d. sigma
-double rndGaussian(double mu, double sigma);
+template<class RNG> inline double rndGaussian(RNG &gen, double mu, double sigma) {
+    double phi = 2 * M_PI * rnd(gen);
+    double R = sqrt(2 * log(1 / (1 - rnd(gen)))) * sigma;
+    return mu + cos(phi) * R;
+}
 
 // Get random standard gaussian
-double rndGaussian();
+template<class RNG> inline double rndGaussian(RNG &gen) {
+    double phi = 2 * M_PI * rnd(gen);
+    double R = sqrt(2 * log(1 / (1 - rnd(gen))));
+    return cos(phi) * R;
+}
+
+// Select the stream of realization run under seed. Streams of different
+// (seed, run) are independent of each other and of the thread they run on.
+inline void InitStream(CRandomPhilox &gen, int seed, int run) {
+    gen.RandomInitStream(seed, run, 0);
+}
+
+inline void InitStream(CRandomMersenne &gen, int seed, int run) {
+    int seeds[2] = {seed, run};
+    gen.RandomInitByArray(seeds, 2);
+}
+
+inline void InitStream(CRandomSFMT &gen, int seed, int run) {
+    int seeds[2] = {seed, run};
+    gen.RandomInitByArray(seeds, 2);
+}
+
+inline void InitStream(CRandomMother &gen, int seed, int run) {
+    // Mother-Of-All takes 32 bits only: mix run into the seed
+    uint32_t s = (uint32_t)seed ^ ((uint32_t)run * 0x9E3779B9U);
+    gen.RandomInit((int)(s ^ (s >> 16)));
+}
 
-#endif
\ No newline at end of file
+#endif
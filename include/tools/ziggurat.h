@@ -0,0 +1,118 @@
+#ifndef ZIGGURAT_H
+#define ZIGGURAT_H
+
+#include <math.h>
+
+// Ziggurat method for standard normal deviates (Marsaglia & Tsang 2000,
+// in the ZIGNOR form of Doornik 2005). The density is covered by 128
+// layers of equal area. A draw picks a layer at random and is accepted
+// straight away when it falls inside the rectangle that lies under the
+// curve, which is about 98.8% of draws. Only the wedges and the tail need
+// exp() or log().
+//
+// The generator is any class with Random() and BRandom(), such as the
+// randomc generators. Unlike rndGaussian() nothing is thrown away, and
+// fill() produces a whole buffer of normals in one call.
+
+class Ziggurat {
+
+private:
+    static const int C = 128;                      // number of layers
+    static constexpr double R = 3.442619855899;    // start of the tail
+    static constexpr double V = 9.91256303526217e-3; // area of one layer
+
+    struct Tables {
+        double x[C + 1];   // right edge of each layer
+        double r[C];       // x[i + 1] / x[i]: fraction of layer i under the curve
+
+        Tables() {
+            double f = exp(-0.5 * R * R);
+            x[0] = V / f;  // bottom layer includes the tail
+            x[1] = R;
+            x[C] = 0.0;
+            for (int i = 2; i < C; i++) {
+                x[i] = sqrt(-2.0 * log(V / x[i - 1] + f));
+                f = exp(-0.5 * x[i] * x[i]);
+            }
+            for (int i = 0; i < C; i++) {
+                r[i] = x[i + 1] / x[i];
+            }
+        }
+    };
+
+    // tables are built once, on first use
+    static const Tables& tables() {
+        static const Tables t;
+        return t;
+    }
+
+    // sample from the tail beyond R
+    template<class RNG> static double tail(RNG &gen, bool negative) {
+        double x, y;
+        do {
+            x = log(1.0 - gen.Random()) / R;
+            y = log(1.0 - gen.Random());
+        } while (-2.0 * y < x * x);
+        return negative ? x - R : R - x;
+    }
+
+public:
+    // Get random standard gaussian
+    template<class RNG> static double next(RNG &gen) {
+        const Tables &t = tables();
+        for (;;) {
+            double u = 2.0 * gen.Random() - 1.0;
+            unsigned int i = gen.BRandom() & (C - 1);
+
+            // inside the rectangle
+            if (fabs(u) < t.r[i]) return u * t.x[i];
+
+            // bottom layer: the tail
+            if (i == 0) return tail(gen, u < 0);
+
+            // in the wedge: accept if under the curve
+            double x = u * t.x[i];
+            double f0 = exp(-0.5 * (t.x[i] * t.x[i] - x * x));
+            double f1 = exp(-0.5 * (t.x[i + 1] * t.x[i + 1] - x * x));
+            if (f1 + gen.Random() * (f0 - f1) < 1.0) return x;
+        }
+    }
+
+    // Fill out[0..n-1] with standard gaussians
+    template<class RNG> static void fill(RNG &gen, double* out, int n) {
+        for (int k = 0; k < n; k++) {
+            out[k] = next(gen);
+        }
+    }
+};
+
+// Buffer of standard gaussians that is refilled in blocks, so the caller
+// pays for one fill() call per SIZE draws.
+class GaussianBuffer {
+
+private:
+    static const int SIZE = 1024;
+    double buffer[SIZE];
+    int pos;
+
+public:
+    GaussianBuffer() {
+        pos = SIZE;
+    }
+
+    // drop buffered values, e.g. after re-seeding the generator
+    void clear() {
+        pos = SIZE;
+    }
+
+    // Get next standard gaussian, refilling from gen when empty
+    template<class RNG> double next(RNG &gen) {
+        if (pos == SIZE) {
+            Ziggurat::fill(gen, buffer, SIZE);
+            pos = 0;
+        }
+        return buffer[pos++];
+    }
+};
+
+#endif
@@ -0,0 +1,182 @@
+/*****************************   jump.h   *************************************
+* Date created:  2026-10-17
+* Project:       randomc
+* Platform:      Any C++ compiler with 64-bit integers
+*
+* Description:
+* Jump-ahead for F2-linear generators (Mersenne twister, SFMT), following
+* H. Haramoto, M. Matsumoto, T. Nishimura, F. Panneton & P. L'Ecuyer:
+* "Efficient jump ahead for F2-linear random number generators".
+* INFORMS Journal on Computing 20 (2008), pp. 385-390.
+*
+* If T is the state transition and P(x) a polynomial with P(T)s = 0, then
+* T^J s = q(T)s with q(x) = x^J mod P(x). This file provides:
+*
+* class CPolynomialGF2:
+* Polynomial with coefficients in GF(2), bit k holds the coefficient of x^k.
+*
+* CPolynomialGF2 MinimalPolynomialGF2(uint8_t const bits[], int n):
+* Berlekamp-Massey. Minimal polynomial of the bit sequence bits[0..n-1],
+* which is the minimal polynomial of T when n >= 2 * (state size in bits).
+*
+* CPolynomialGF2 JumpPolynomialGF2(CPolynomialGF2 const &p, int log2jump):
+* x^(2^log2jump) mod p(x).
+*
+* void ApplyJumpGF2(CPolynomialGF2 const &q, TState &s):
+* Replace s by q(T)s: steps s through T^j s, j = 0..deg q, and adds
+* up the terms with q_j = 1. TState must provide Clear(), Next() (one step of
+* T) and Add(TState const &) (exclusive or).
+*
+* Copyright notice
+* ================
+* GNU General Public License http://www.gnu.org/licenses/gpl.html
+*******************************************************************************/
+
+#ifndef JUMP_H
+#define JUMP_H
+
+#include <algorithm>
+#include <vector>
+#include "randomc.h"                   // Define integer types etc
+
+class CPolynomialGF2 {                 // Polynomial over GF(2)
+public:
+   CPolynomialGF2(int maxdegree = 0) { // Zero polynomial of degree <= maxdegree
+      w.assign(maxdegree / 64 + 1, 0);}
+   int Degree() const {                // Degree, -1 for the zero polynomial
+      for (int i = (int)w.size() - 1; i >= 0; i--) {
+         if (w[i]) return i * 64 + 63 - __builtin_clzll(w[i]);
+      }
+      return -1;}
+   int Coefficient(int k) const {      // Coefficient of x^k
+      return k / 64 < (int)w.size() ? (int)(w[k / 64] >> (k % 64)) & 1 : 0;}
+   void Set(int k) {                   // Set coefficient of x^k to 1
+      if (k / 64 >= (int)w.size()) w.resize(k / 64 + 1, 0);
+      w[k / 64] |= (uint64_t)1 << (k % 64);}
+   std::vector<uint64_t> w;            // Coefficients, 64 per word
+};
+
+
+// Exclusive or of src shifted left by 'shift' bits into dst
+static inline void XorShiftedGF2(std::vector<uint64_t> &dst, std::vector<uint64_t> const &src, int shift) {
+   int ws = shift / 64, bs = shift % 64;
+   int n = (int)src.size();
+   if (dst.size() < src.size() + ws + 1) dst.resize(src.size() + ws + 1, 0);
+   if (bs == 0) {
+      for (int i = 0; i < n; i++) dst[i + ws] ^= src[i];
+   }
+   else {
+      uint64_t carry = 0;
+      for (int i = 0; i < n; i++) {
+         dst[i + ws] ^= (src[i] << bs) | carry;
+         carry = src[i] >> (64 - bs);
+      }
+      dst[n + ws] ^= carry;
+   }
+}
+
+
+static inline CPolynomialGF2 MinimalPolynomialGF2(uint8_t const bits[], int n) {
+   // Berlekamp-Massey over GF(2). Returns the characteristic polynomial
+   // x^L + c1 x^(L-1) + ... + cL of the shortest recursion
+   // s[k] = c1 s[k-1] + ... + cL s[k-L] that generates bits[].
+   CPolynomialGF2 c(n), b(n), t;       // Connection polynomials 1 + c1 x + ...
+   c.Set(0);  b.Set(0);
+   int L = 0, m = -1;
+
+   // Sequence bits in reverse, so that sum c_i s[k-i] is a word-wise product
+   std::vector<uint64_t> rev(n / 64 + 3, 0);
+   for (int k = 0; k < n; k++) {
+      if (bits[k]) rev[(n - 1 - k) / 64] |= (uint64_t)1 << ((n - 1 - k) % 64);
+   }
+
+   for (int k = 0; k < n; k++) {
+      // Discrepancy d = sum_{i=0..L} c_i s[k-i] = sum_i c_i rev[n-1-k+i]
+      int off = n - 1 - k, ws = off / 64, bs = off % 64;
+      uint64_t d = 0;
+      for (int i = 0; i <= L / 64; i++) {
+         uint64_t r = rev[ws + i] >> bs;
+         if (bs) r |= rev[ws + i + 1] << (64 - bs);
+         d ^= c.w[i] & r;
+      }
+      if (!(__builtin_popcountll(d) & 1)) continue;
+
+      // c(x) -= x^(k-m) b(x)
+      if (2 * L <= k) {
+         t = c;
+         XorShiftedGF2(c.w, b.w, k - m);
+         L = k + 1 - L;  m = k;  b = t;
+      }
+      else {
+         XorShiftedGF2(c.w, b.w, k - m);
+      }
+   }
+
+   // Reverse connection polynomial into characteristic polynomial
+   CPolynomialGF2 p(L);
+   for (int i = 0; i <= L; i++) {
+      if (c.Coefficient(i)) p.Set(L - i);
+   }
+   return p;
+}
+
+
+static inline CPolynomialGF2 JumpPolynomialGF2(CPolynomialGF2 const &p, int log2jump) {
+   // x^(2^log2jump) mod p(x), by repeated squaring
+   int L = p.Degree();
+   int nw = L / 64 + 1;
+
+   // p(x) x^s for s = 0..63, for word-aligned reduction
+   std::vector<uint64_t> shifted[64];
+   for (int s = 0; s < 64; s++) {
+      shifted[s].assign(nw + 1, 0);
+      XorShiftedGF2(shifted[s], p.w, s);
+   }
+
+   CPolynomialGF2 q(L);
+   q.Set(1);
+   if (L <= 1) {                       // x mod p for degree 1
+      q = CPolynomialGF2(0);
+      if (p.Coefficient(0)) q.Set(0);
+   }
+   std::vector<uint64_t> sq(2 * nw + 2);
+   for (int r = 0; r < log2jump; r++) {
+      // Square: spread the bits of every word into two words
+      std::fill(sq.begin(), sq.end(), 0);
+      for (int i = 0; i < nw; i++) {
+         uint64_t x = i < (int)q.w.size() ? q.w[i] : 0;
+         uint64_t lo = 0, hi = 0;
+         for (int j = 0; j < 32; j++) {
+            lo |= ((x >> j) & 1) << (2 * j);
+            hi |= ((x >> (j + 32)) & 1) << (2 * j);
+         }
+         sq[2 * i] = lo;  sq[2 * i + 1] = hi;
+      }
+      // Reduce modulo p, from the top down
+      for (int k = 2 * L; k >= L; k--) {
+         if ((sq[k / 64] >> (k % 64)) & 1) {
+            int t = k - L, ws = t / 64;
+            std::vector<uint64_t> const &ps = shifted[t % 64];
+            for (int i = 0; i <= nw && i + ws < (int)sq.size(); i++) sq[i + ws] ^= ps[i];
+         }
+      }
+      q.w.assign(sq.begin(), sq.begin() + nw);
+   }
+   return q;
+}
+
+
+template <class TState>
+static void ApplyJumpGF2(CPolynomialGF2 const &q, TState &s) {
+   // Replace s by q(T)s = sum_j q_j T^j s
+   TState result = s;
+   result.Clear();
+   int deg = q.Degree();
+   for (int j = 0; j <= deg; j++) {
+      if (q.Coefficient(j)) result.Add(s);
+      if (j < deg) s.Next();
+   }
+   s = result;
+}
+
+#endif // JUMP_H
@@ -23,6 +23,7 @@
 *******************************************************************************/
 
 #include "randomc.h"
+#include "jump.h"
 
 void CRandomMersenne::Init0(int seed) {
    // Seed generator
@@ -181,3 +182,74 @@ int CRandomMersenne::IRandomX(int min, int max) {
 
 #endif
 }
+
+
+/***********************************************************************
+                     Jump ahead
+***********************************************************************/
+
+// State vector as a ring buffer with start index i. One call to Next()
+// produces one new word, like one step of the loop in BRandom().
+struct CMersenneRing {
+   uint32_t s[MERS_N];
+   int i;
+   void Clear() {
+      for (int k = 0; k < MERS_N; k++) s[k] = 0;
+      i = 0;}
+   void Next() {
+      const uint32_t LOWER_MASK = (1LU << MERS_R) - 1;
+      const uint32_t UPPER_MASK = 0xFFFFFFFF << MERS_R;
+      uint32_t y = (s[i] & UPPER_MASK) | (s[(i+1) % MERS_N] & LOWER_MASK);
+      s[i] = s[(i+MERS_M) % MERS_N] ^ (y >> 1) ^ ((y & 1) ? MERS_A : 0);
+      i = (i + 1) % MERS_N;}
+   void Add(CMersenneRing const &r) {
+      for (int k = 0; k < MERS_N; k++) s[(i+k) % MERS_N] ^= r.s[(r.i+k) % MERS_N];}
+};
+
+
+static CPolynomialGF2 MersenneCharacteristicPolynomial() {
+   // The characteristic polynomial is the same for every seed. Find it from
+   // the lowest output bit of an arbitrary generator
+   const int nbits = 2 * 32 * MERS_N;
+   std::vector<uint8_t> bits(nbits);
+   CRandomMersenne gen(5489);
+   for (int k = 0; k < nbits; k++) bits[k] = gen.BRandom() & 1;
+   return MinimalPolynomialGF2(&bits[0], nbits);
+}
+
+
+static CPolynomialGF2 MersenneJumpPolynomial(int log2n) {
+   // x^(2^log2n) modulo the characteristic polynomial, which is found once
+   static const CPolynomialGF2 p = MersenneCharacteristicPolynomial();
+   return JumpPolynomialGF2(p, log2n);
+}
+
+
+void CRandomMersenne::JumpBy(CPolynomialGF2 const &q) {
+   // mt[] holds the words x[b] ... x[b+MERS_N-1] of the current block and the
+   // next output is x[b+mti]. Jump the block and keep mti.
+   CMersenneRing r;
+   for (int k = 0; k < MERS_N; k++) r.s[k] = mt[k];
+   r.i = 0;
+   ApplyJumpGF2(q, r);
+   for (int k = 0; k < MERS_N; k++) mt[k] = r.s[(r.i+k) % MERS_N];
+}
+
+
+void CRandomMersenne::Jump(int log2n) {
+   // Skip 2^log2n outputs
+   JumpBy(MersenneJumpPolynomial(log2n));
+}
+
+
+std::vector<CRandomMersenne> CRandomMersenne::Split(int n, int log2spacing) {
+   // n generators, 2^log2spacing outputs apart. The jump polynomial is
+   // computed once and applied n times.
+   CPolynomialGF2 q = MersenneJumpPolynomial(log2spacing);
+   std::vector<CRandomMersenne> streams;
+   for (int k = 0; k < n; k++) {
+      streams.push_back(*this);
+      JumpBy(q);
+   }
+   return streams;
+}
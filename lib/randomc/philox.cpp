@@ -0,0 +1,129 @@
+/*****************************   philox.cpp   *********************************
+* Date created:  2026-10-17
+* Project:       randomc
+* Platform:      Any C++ compiler with 64-bit integers
+*
+* Description:
+* Counter-based random number generator of type Philox4x32-10.
+* Each block of four 32-bit outputs is ten rounds of a Feistel-like
+* bijection of the 128-bit counter under the 64-bit key:
+*
+*    (c0,c1,c2,c3) -> (hi(M1*c2)^c1^k0, lo(M1*c2), hi(M0*c0)^c3^k1, lo(M0*c0))
+*
+* with the key bumped by the Weyl constants W0, W1 between rounds.
+*
+* The key holds (run, substream) and the counter holds the block number in
+* its low 64 bits and the seed in its high 64 bits.
+*
+* Class description and member functions: See philox.h
+*
+* Copyright notice
+* ================
+* GNU General Public License http://www.gnu.org/licenses/gpl.html
+*******************************************************************************/
+
+#include "philox.h"                    // Class definition and other declarations
+
+// Philox4x32 multipliers and Weyl key increments
+#define PHILOX_M0  0xD2511F53U
+#define PHILOX_M1  0xCD9E8D57U
+#define PHILOX_W0  0x9E3779B9U
+#define PHILOX_W1  0xBB67AE85U
+#define PHILOX_ROUNDS 10
+
+
+void CRandomPhilox::RandomInitStream(int seed, uint32_t run, uint32_t substream) {
+   // Select stream and go to its start
+   key[0] = run;
+   key[1] = substream;
+   counter[0] = 0;
+   counter[1] = 0;
+   counter[2] = (uint32_t)seed;
+   counter[3] = 0;
+   ix = 4;                             // Output is empty: generate on next call
+}
+
+
+void CRandomPhilox::Seek(uint64_t position) {
+   // Jump to the 32-bit number with index position in the current stream
+   uint64_t block = position >> 2;
+   counter[0] = (uint32_t)block;
+   counter[1] = (uint32_t)(block >> 32);
+   Generate();
+   ix = (uint32_t)(position & 3);
+}
+
+
+void CRandomPhilox::Generate() {
+   // Encrypt counter into output and advance counter
+   uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+   uint32_t k0 = key[0], k1 = key[1];
+   uint64_t p0, p1;
+
+   for (int round = 0; round < PHILOX_ROUNDS; round++) {
+      p0 = (uint64_t)PHILOX_M0 * c0;
+      p1 = (uint64_t)PHILOX_M1 * c2;
+      c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+      c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+      c1 = (uint32_t)p1;
+      c3 = (uint32_t)p0;
+      k0 += PHILOX_W0;
+      k1 += PHILOX_W1;
+   }
+   output[0] = c0;  output[1] = c1;  output[2] = c2;  output[3] = c3;
+
+   // 64-bit block counter
+   if (++counter[0] == 0) counter[1]++;
+   ix = 0;
+}
+
+
+int CRandomPhilox::IRandom(int min, int max) {
+   // Output random integer in the interval min <= x <= max
+   // Relative error on frequencies < 2^-32
+   if (max <= min) {
+      if (max == min) return min; else return 0x80000000;
+   }
+   // Assume 64 bit integers supported. Use multiply and shift method
+   uint32_t interval;                  // Length of interval
+   uint64_t longran;                   // Random bits * interval
+   uint32_t iran;                      // Longran / 2^32
+
+   interval = (uint32_t)(max - min + 1);
+   longran  = (uint64_t)BRandom() * interval;
+   iran = (uint32_t)(longran >> 32);
+   // Convert back to signed and return result
+   return (int32_t)iran + min;
+}
+
+
+int CRandomPhilox::IRandomX(int min, int max) {
+   // Output random integer in the interval min <= x <= max
+   // Each output value has exactly the same probability.
+   // This is obtained by rejecting certain bit values so that the number
+   // of possible bit values is divisible by the interval length
+   if (max <= min) {
+      if (max == min) return min; else return 0x80000000;
+   }
+   // Assume 64 bit integers supported. Use multiply and shift method
+   uint32_t interval;                  // Length of interval
+   uint64_t longran;                   // Random bits * interval
+   uint32_t iran;                      // Longran / 2^32
+   uint32_t remainder;                 // Longran % 2^32
+
+   interval = (uint32_t)(max - min + 1);
+   if (interval != LastInterval) {
+      // Interval length has changed. Must calculate rejection limit
+      // Reject when remainder >= 2^32 / interval * interval
+      // RLimit will be 0 if interval is a power of 2. No rejection then
+      RLimit = (uint32_t)(((uint64_t)1 << 32) / interval) * interval - 1;
+      LastInterval = interval;
+   }
+   do { // Rejection loop
+      longran  = (uint64_t)BRandom() * interval;
+      iran = (uint32_t)(longran >> 32);
+      remainder = (uint32_t)longran;
+   } while (remainder > RLimit);
+   // Convert back to signed and return result
+   return (int32_t)iran + min;
+}
@@ -64,6 +64,15 @@
 * uint32_t BRandom();
 * Gives 32 random bits. 
 *
+* void Jump(int log2n);
+* In CRandomMersenne and CRandomSFMT only: Skip ahead by 2^log2n numbers
+* from BRandom() without generating them (see jump.h).
+*
+* std::vector<...> Split(int n, int log2spacing = 100);
+* In CRandomMersenne and CRandomSFMT only: Returns n copies of the generator
+* that start 2^log2spacing numbers apart, so they do not overlap for fewer
+* draws than that. The generator itself continues after the last copy.
+*
 *
 * Example:
 * ========
@@ -132,6 +141,10 @@ void EndOfProgram(void);               // System-specific exit code (userintf.cp
 void FatalError(const char *ErrorText);// System-specific error reporting (userintf.cpp)
 
 #if defined(__cplusplus)               // class definitions only in C++
+#include <vector>
+
+class CPolynomialGF2;                  // Jump polynomial (jump.h)
+
 /***********************************************************************
 Define random number generator classes
 ***********************************************************************/
@@ -173,8 +186,11 @@ public:
    int IRandomX(int min, int max);     // Output random integer, exact
    double Random();                    // Output random float
    uint32_t BRandom();                 // Output random bits
+   void Jump(int log2n);               // Skip 2^log2n outputs
+   std::vector<CRandomMersenne> Split(int n, int log2spacing = 100); // Non-overlapping substreams
 private:
    void Init0(int seed);               // Basic initialization procedure
+   void JumpBy(CPolynomialGF2 const &q);  // Apply jump polynomial
    uint32_t mt[MERS_N];                // State vector
    int mti;                            // Index into mt
    uint32_t LastInterval;              // Last interval length for IRandomX
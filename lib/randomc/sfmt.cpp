@@ -72,6 +72,8 @@ THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 *******************************************************************************/
 
+#include <string.h>                    // Define memcpy
+#include <immintrin.h>                 // Define AVX2 and AVX-512 intrinsics
 #include "sfmt.h"                      // Class definition and other declarations
 
 
@@ -240,8 +242,19 @@ __m128i const &c, __m128i const &d, __m128i const &mask) {
     return z2;
 }
 
-void CRandomSFMT::Generate() {
-   // Fill state array with new random numbers
+/***********************************************************************
+                     Generation kernels
+***********************************************************************/
+// Each new word is w[i] = A(w[i], w[i+M]) ^ B(w[i-2], w[i-1]). The part
+// B depends on the two words just made and must be done one 128-bit word
+// at a time. The part A only depends on words that are already final, so
+// the AVX2 and AVX-512 kernels compute it for 2 or 4 words per instruction
+// (the byte shift works per 128-bit lane) and then run the chain B.
+// Words i >= N-M read w[i+M-N], which is final when the chunk is no wider
+// than N-M words. All kernels give identical output.
+
+static void sfmt_generate_sse2(__m128i * state, __m128i const &mask) {
+   // Fill state array with new random numbers, one word at a time
    int i;
    __m128i r, r1, r2;
 
@@ -259,9 +272,167 @@ void CRandomSFMT::Generate() {
       r1 = r2;
       r2 = r;
    }
+}
+
+// Part A of the recursion for one word
+static inline __m128i sfmt_part_a(__m128i const &a, __m128i const &b, __m128i const &mask) {
+   return _mm_xor_si128(_mm_xor_si128(a, _mm_slli_si128(a, SFMT_SL2)),
+      _mm_and_si128(_mm_srli_epi32(b, SFMT_SR1), mask));
+}
+
+// Finish words state[i..i+n-1] from their part A in z[]
+static inline void sfmt_chain(__m128i * state, int i, int n, __m128i const * z, __m128i &r1, __m128i &r2) {
+   for (int k = 0; k < n; k++) {
+      __m128i r = _mm_xor_si128(z[k],
+         _mm_xor_si128(_mm_srli_si128(r1, SFMT_SR2), _mm_slli_epi32(r2, SFMT_SL1)));
+      state[i + k] = r;
+      r1 = r2;
+      r2 = r;
+   }
+}
+
+__attribute__((target("avx2")))
+static void sfmt_generate_avx2(__m128i * state, __m128i const &mask) {
+   // Fill state array with new random numbers, part A two words at a time
+   const __m256i mask2 = _mm256_broadcastsi128_si256(mask);
+   __m128i r1 = state[SFMT_N - 2], r2 = state[SFMT_N - 1];
+   __m128i z[2];
+   int i = 0;
+   for (int part = 0; part < 2; part++) {
+      int end = part ? SFMT_N : SFMT_N - SFMT_M;  // Word range of this part
+      int off = part ? SFMT_M - SFMT_N : SFMT_M;  // Offset of w[i+M]
+      for (; i + 2 <= end; i += 2) {
+         __m256i a = _mm256_loadu_si256((__m256i const*)&state[i]);
+         __m256i b = _mm256_loadu_si256((__m256i const*)&state[i + off]);
+         __m256i t = _mm256_xor_si256(_mm256_xor_si256(a, _mm256_slli_si256(a, SFMT_SL2)),
+            _mm256_and_si256(_mm256_srli_epi32(b, SFMT_SR1), mask2));
+         _mm256_storeu_si256((__m256i*)z, t);
+         sfmt_chain(state, i, 2, z, r1, r2);
+      }
+      for (; i < end; i++) {
+         z[0] = sfmt_part_a(state[i], state[i + off], mask);
+         sfmt_chain(state, i, 1, z, r1, r2);
+      }
+   }
+}
+
+// GCC 12 warns about the undefined upper part in its own AVX-512 headers
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f,avx512bw")))
+static void sfmt_generate_avx512(__m128i * state, __m128i const &mask) {
+   // Fill state array with new random numbers, part A four words at a time
+   const __m512i mask4 = _mm512_broadcast_i32x4(mask);
+   __m128i r1 = state[SFMT_N - 2], r2 = state[SFMT_N - 1];
+   __m128i z[4];
+   int i = 0;
+   for (int part = 0; part < 2; part++) {
+      int end = part ? SFMT_N : SFMT_N - SFMT_M;  // Word range of this part
+      int off = part ? SFMT_M - SFMT_N : SFMT_M;  // Offset of w[i+M]
+      for (; i + 4 <= end; i += 4) {
+         __m512i a = _mm512_loadu_si512((void const*)&state[i]);
+         __m512i b = _mm512_loadu_si512((void const*)&state[i + off]);
+         __m512i t = _mm512_xor_si512(_mm512_xor_si512(a, _mm512_bslli_epi128(a, SFMT_SL2)),
+            _mm512_and_si512(_mm512_srli_epi32(b, SFMT_SR1), mask4));
+         _mm512_storeu_si512((void*)z, t);
+         sfmt_chain(state, i, 4, z, r1, r2);
+      }
+      for (; i < end; i++) {
+         z[0] = sfmt_part_a(state[i], state[i + off], mask);
+         sfmt_chain(state, i, 1, z, r1, r2);
+      }
+   }
+}
+#pragma GCC diagnostic pop
+
+typedef void (*SFMTKernel)(__m128i * state, __m128i const &mask);
+
+// Kernel in use, chosen by CPUID at program start
+static int sfmt_kernel_id = 0;
+static SFMTKernel sfmt_kernel = sfmt_generate_sse2;
+
+int CRandomSFMT::SelectKernel(int kernel) {
+   // Select generation kernel, or the best supported one if kernel = 0.
+   // Falls back to a narrower kernel if the requested one is not supported.
+   // Returns the kernel selected. Not thread safe: call before starting threads.
+   __builtin_cpu_init();
+   bool avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+      && SFMT_N - SFMT_M >= 4;
+   bool avx2 = __builtin_cpu_supports("avx2") && SFMT_N - SFMT_M >= 2;
+   if (kernel == 0 || kernel > SFMT_KERNEL_AVX512) kernel = SFMT_KERNEL_AVX512;
+   if (kernel == SFMT_KERNEL_AVX512 && !avx512) kernel = SFMT_KERNEL_AVX2;
+   if (kernel == SFMT_KERNEL_AVX2 && !avx2) kernel = SFMT_KERNEL_SSE2;
+   switch (kernel) {
+   case SFMT_KERNEL_AVX512: sfmt_kernel = sfmt_generate_avx512; break;
+   case SFMT_KERNEL_AVX2:   sfmt_kernel = sfmt_generate_avx2;   break;
+   default:                 sfmt_kernel = sfmt_generate_sse2;   break;
+   }
+   sfmt_kernel_id = kernel;
+   return kernel;
+}
+
+static int sfmt_kernel_init = CRandomSFMT::SelectKernel(0);
+
+const char * CRandomSFMT::KernelName() {
+   // Name of the kernel in use
+   switch (sfmt_kernel_id) {
+   case SFMT_KERNEL_AVX512: return "AVX-512";
+   case SFMT_KERNEL_AVX2:   return "AVX2";
+   case SFMT_KERNEL_SSE2:   return "SSE2";
+   default:                 return "none selected";
+   }
+}
+
+void CRandomSFMT::Generate() {
+   // Fill state array with new random numbers
+   // (a generator made during static initialization may come first)
+   if (sfmt_kernel_id == 0) SelectKernel(0);
+   sfmt_kernel(state, mask);
    ix = 0;
 }
 
+
+/***********************************************************************
+                     Bulk output
+***********************************************************************/
+
+void CRandomSFMT::Fill(uint32_t * out, int n) {
+   // Same numbers as n calls to BRandom()
+   if (UseMother) {
+      for (int k = 0; k < n; k++) out[k] = BRandom();
+      return;
+   }
+   while (n > 0) {
+      if (ix >= SFMT_N*4) Generate();
+      int k = SFMT_N*4 - ix;
+      if (k > n) k = n;
+      memcpy(out, (uint32_t*)state + ix, k * sizeof(uint32_t));
+      ix += k;  out += k;  n -= k;
+   }
+}
+
+void CRandomSFMT::Fill(double * out, int n) {
+   // Same numbers as n calls to Random()
+   if (UseMother) {
+      for (int k = 0; k < n; k++) out[k] = Random();
+      return;
+   }
+   while (n > 0) {
+      if (ix >= SFMT_N*4-1) Generate();
+      int k = (SFMT_N*4 - ix) / 2;
+      if (k > n) k = n;
+      uint64_t const * r = (uint64_t const*)((uint32_t*)state + ix);
+      for (int j = 0; j < k; j++) {
+         // (r >> 12) * 2^(-52), exactly, as 1.mantissa - 1
+         union {uint64_t i; double d;} u;
+         u.i = (r[j] >> 12) | 0x3FF0000000000000ULL;
+         out[j] = u.d - 1.0;
+      }
+      ix += 2 * k;  out += k;  n -= k;
+   }
+}
+
 uint32_t CRandomSFMT::BRandom() {
    // Output 32 random bits
    uint32_t y;
@@ -365,3 +536,99 @@ double CRandomSFMT::Random() {
    // 52 bits resolution for compatibility with assembly version:
    return (int64_t)(r >> 12) * (1./(67108864.0*67108864.0));  // (r >> 12)*2^(-52)
 }
+
+
+/***********************************************************************
+                     Jump ahead
+***********************************************************************/
+
+// State vector as a ring buffer with start index i. One call to Next()
+// produces one new 128-bit word, like one step of the loop in Generate().
+struct CSFMTRing {
+   __m128i s[SFMT_N];
+   __m128i mask;
+   int i;
+   void Clear() {
+      for (int k = 0; k < SFMT_N; k++) s[k] = _mm_setzero_si128();
+      i = 0;}
+   void Next() {
+      s[i] = sfmt_recursion(s[i], s[(i + SFMT_M) % SFMT_N],
+         s[(i + SFMT_N - 2) % SFMT_N], s[(i + SFMT_N - 1) % SFMT_N], mask);
+      i = (i + 1) % SFMT_N;}
+   void Add(CSFMTRing const &r) {
+      for (int k = 0; k < SFMT_N; k++) {
+         s[(i + k) % SFMT_N] = _mm_xor_si128(s[(i + k) % SFMT_N], r.s[(r.i + k) % SFMT_N]);
+      }}
+   bool IsZero() const {
+      __m128i z = _mm_setzero_si128();
+      for (int k = 0; k < SFMT_N; k++) z = _mm_or_si128(z, s[k]);
+      return _mm_movemask_epi8(_mm_cmpeq_epi8(z, _mm_setzero_si128())) == 0xFFFF;}
+};
+
+
+CPolynomialGF2 CRandomSFMT::JumpPolynomial(int log2n) {
+   // The state space of SFMT is larger than MEXP, so the minimal polynomial
+   // may depend on the state. Find it with Berlekamp-Massey from one bit of
+   // the words following the current block, and check that it annihilates
+   // the state. Try the next bit if it does not.
+   if (UseMother) {
+      FatalError("CRandomSFMT::Jump: cannot jump ahead when combined with Mother-Of-All");
+   }
+   if (log2n < 2) {
+      FatalError("CRandomSFMT::Jump: jump must be a multiple of 4 outputs");
+   }
+   const int nbits = 2 * 128 * SFMT_N;
+   std::vector<uint8_t> bits(nbits);
+   CSFMTRing start;
+   for (int k = 0; k < SFMT_N; k++) start.s[k] = state[k];
+   start.mask = mask;
+   start.i = 0;
+
+   for (int bit = 0; bit < 128; bit++) {
+      CSFMTRing r = start;
+      for (int k = 0; k < nbits; k++) {
+         bits[k] = (((uint32_t*)&r.s[r.i])[bit / 32] >> (bit % 32)) & 1;
+         r.Next();
+      }
+      CPolynomialGF2 p = MinimalPolynomialGF2(&bits[0], nbits);
+      r = start;
+      ApplyJumpGF2(p, r);
+      if (r.IsZero()) {
+         // One step of the ring is four 32-bit outputs
+         return JumpPolynomialGF2(p, log2n - 2);
+      }
+   }
+   FatalError("CRandomSFMT::Jump: no minimal polynomial found");
+   return CPolynomialGF2();
+}
+
+
+void CRandomSFMT::JumpBy(CPolynomialGF2 const &q) {
+   // state[] holds the current block and the next output is at ix.
+   // Jump the block and keep ix.
+   CSFMTRing r;
+   for (int k = 0; k < SFMT_N; k++) r.s[k] = state[k];
+   r.mask = mask;
+   r.i = 0;
+   ApplyJumpGF2(q, r);
+   for (int k = 0; k < SFMT_N; k++) state[k] = r.s[(r.i + k) % SFMT_N];
+}
+
+
+void CRandomSFMT::Jump(int log2n) {
+   // Skip 2^log2n 32-bit outputs
+   JumpBy(JumpPolynomial(log2n));
+}
+
+
+std::vector<CRandomSFMT> CRandomSFMT::Split(int n, int log2spacing) {
+   // n generators, 2^log2spacing outputs apart. The jump polynomial is
+   // computed once and applied n times.
+   CPolynomialGF2 q = JumpPolynomial(log2spacing);
+   std::vector<CRandomSFMT> streams;
+   for (int k = 0; k < n; k++) {
+      streams.push_back(*this);
+      JumpBy(q);
+   }
+   return streams;
+}
@@ -63,6 +63,27 @@
 * uint32_t BRandom();
 * Gives 32 random bits. 
 *
+* void Jump(int log2n);
+* Skip ahead by 2^log2n 32-bit numbers (log2n >= 2) without generating
+* them. Not possible when combined with the Mother-Of-All generator.
+*
+* void Fill(uint32_t out[], int n);
+* void Fill(double out[], int n);
+* Fill out[] with the same n numbers as n calls to BRandom() or Random(),
+* copied a block at a time from the state vector.
+*
+* static int SelectKernel(int kernel);
+* static const char * KernelName();
+* New random numbers are made by an SSE2, AVX2 or AVX-512 kernel. The best
+* one supported by the CPU is chosen at first use. SelectKernel forces one
+* of SFMT_KERNEL_SSE2, SFMT_KERNEL_AVX2 or SFMT_KERNEL_AVX512, falling back
+* to a narrower one if unsupported, and returns the one selected. All
+* kernels give identical output.
+*
+* std::vector<CRandomSFMT> Split(int n, int log2spacing = 100);
+* Returns n copies of the generator that start 2^log2spacing 32-bit numbers
+* apart. The generator itself continues after the last copy.
+*
 *
 * Example:
 * ========
@@ -126,6 +147,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <emmintrin.h>                 // Define SSE2 intrinsics
 #include "randomc.h"                   // Define integer types etc
+#include "jump.h"                      // Polynomial jump ahead
 
 // Choose one of the possible Mersenne exponents.
 // Higher values give longer cycle length and use more memory:
@@ -209,6 +231,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define SFMT_PARITY 0x00000001, 0x00000000, 0x00000000, 0x5986f054  // Period certification vector
 #endif
 
+// Generation kernels
+#define SFMT_KERNEL_SSE2    1
+#define SFMT_KERNEL_AVX2    2
+#define SFMT_KERNEL_AVX512  3
+
 // Class for SFMT generator with or without Mother-Of-All generator
 class CRandomSFMT {                              // Encapsulate random number generator
 public:
@@ -222,7 +249,15 @@ public:
    int  IRandomX (int min, int max);             // Output random integer, exact
    double Random();                              // Output random floating point number
    uint32_t BRandom();                           // Output random bits
+   void Fill(uint32_t * out, int n);             // Output n times random bits
+   void Fill(double * out, int n);               // Output n random floating point numbers
+   static int SelectKernel(int kernel);          // Choose generation kernel
+   static const char * KernelName();             // Name of kernel in use
+   void Jump(int log2n);                         // Skip 2^log2n outputs
+   std::vector<CRandomSFMT> Split(int n, int log2spacing = 100); // Non-overlapping substreams
 private:
+   CPolynomialGF2 JumpPolynomial(int log2n);     // Jump polynomial for 2^log2n outputs
+   void JumpBy(CPolynomialGF2 const &q);         // Apply jump polynomial
    void Init2();                                 // Various initializations and period certification
    void Generate();                              // Fill state array with new random numbers
    uint32_t MotherBits();                        // Get random bits from Mother-Of-All generator
@@ -0,0 +1,326 @@
+/*************************************************************************
+ *  Measures how the Simulator scales with the number of steps
+ *
+ *  Compilation:      make bench
+ *
+ *  Execution:        ./bench.out [--min-steps N] [--max-steps N] [--repeats R]
+ *                                [--seed S] [--run R] [--rng philox|mersenne|mother|sfmt]
+ *                                [--mode stream|full|lambda|both|all] [--json FILE]
+ *                    Example :
+ *                    ./bench.out --max-steps 10000000 --repeats 5 --json bench.json
+ *
+ *  Runs one realization (seed, run) for every power of ten from
+ *  --min-steps (default 10^3) to --max-steps (default 10^7), repeats
+ *  each --repeats times (default 5) and prints per size the median and
+ *  fastest ns/step and the memory the run needs. Every repeat
+ *  is the same realization, so it does the same work. Many realizations
+ *  stop early because the root becomes negative, so without --run the
+ *  first run of the seed that reaches --max-steps is used (this search
+ *  also warms up the caches). A run that stops early anyway is timed
+ *  over the steps it made, which are printed too.
+ *
+ *  Mode stream hands the steps to a sink that only counts them, so it
+ *  measures the recurrence itself; mode full keeps the Trajectory with
+ *  all 9 columns, mode lambda only the lambda column (LambdaColumns),
+ *  as main.out does without --stream. Mode both runs stream and full,
+ *  all (the default) all three. For each mode a least squares fit of
+ *  log(time) on log(steps) gives the scaling exponent: 1 for a constant
+ *  cost per step, 2 for the old O(N^2) volume loop.
+ *
+ *  The memory is measured once per size in a forked child, which runs
+ *  the realization on a fresh arena: the growth of its peak resident
+ *  set (getrusage maxrss) during the run. A leak or an arena that
+ *  grows more than it should shows up there. Next to it, "held" is
+ *  what the run should hold by count: the Simulator and the sink,
+ *  plus for full and lambda the Trajectory carved from the arena.
+ *
+ *  With --json the same numbers are written to FILE for scripts that
+ *  compare against an earlier run.
+ *
+ *************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <algorithm>
+#include <vector>
+#include "../include/Simulator.h"
+
+struct Options {
+    long long minsteps;
+    long long maxsteps;
+    int repeats;
+    int seed;
+    int run;
+    const char* rng;
+    const char* mode;
+    const char* json;
+};
+
+// One step count of the sweep
+struct Result {
+    const char* mode;
+    int steps;          // requested
+    int made;           // steps actually run
+    std::vector<double> seconds;
+    double median;      // ns/step
+    double fastest;     // ns/step
+    double memory;      // growth of the peak resident set during the run, bytes
+    double held;        // bytes the run holds by count
+};
+
+// Sink that only counts the steps it is handed
+struct CountingSink {
+    long long rows;
+    double last;
+    void record(int i, const SimulatorState &s) {
+        rows++;
+        last = s.lambda;
+    }
+};
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Peak resident set of this process in bytes
+static double maxResident() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss * 1024.0;
+}
+
+// Growth of the peak resident set while a forked child runs the
+// realization once on a fresh arena; 0 if the child fails
+template <class RNG, class Columns>
+double measureMemory(const Options &o, bool full, int steps) {
+    int fds[2];
+    if (pipe(fds) != 0) return 0.0;
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        // hold the arena of the thread, so the run maps one of its own
+        static char holder;
+        Arena::local().claim(&holder);
+        double before = maxResident();
+        {
+            Simulator<RNG, Columns> simulator(steps, o.seed, o.run, false);
+            CountingSink sink = { 0, 0.0 };
+            if (full) {
+                simulator.runSimulation();
+            } else {
+                simulator.runSimulation(sink);
+            }
+        }
+        double grown = maxResident() - before;
+        ssize_t written = write(fds[1], &grown, sizeof(grown));
+        _exit(written == sizeof(grown) ? 0 : 1);
+    }
+    close(fds[1]);
+    double grown = 0.0;
+    if (pid < 0 || read(fds[0], &grown, sizeof(grown)) != sizeof(grown)) {
+        grown = 0.0;
+    }
+    close(fds[0]);
+    if (pid > 0) waitpid(pid, NULL, 0);
+    return grown;
+}
+
+// Time repeats of one realization of the given number of steps;
+// Columns: what a full run keeps
+template <class RNG, class Columns>
+Result measure(const Options &o, const char* mode, int steps) {
+    Result r;
+    r.mode = mode;
+    r.steps = steps;
+    r.made = 0;
+    bool full = strcmp(mode, "stream") != 0;
+    r.memory = measureMemory<RNG, Columns>(o, full, steps);
+    r.held = sizeof(Simulator<RNG, Columns>) + sizeof(CountingSink);
+    if (full) {
+        r.held += Arena::aligned(sizeof(TrajectoryOf<Columns>)) + TrajectoryOf<Columns>::bytes(steps);
+    }
+    for (int k = 0; k < o.repeats; k++) {
+        Simulator<RNG, Columns> simulator(steps, o.seed, o.run, false);
+        CountingSink sink = { 0, 0.0 };
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (full) {
+            simulator.runSimulation();
+        } else {
+            simulator.runSimulation(sink);
+        }
+        r.seconds.push_back(seconds(start));
+        r.made = simulator.getLastStep();
+    }
+    std::vector<double> sorted = r.seconds;
+    std::sort(sorted.begin(), sorted.end());
+    int n = (int) sorted.size();
+    double median = n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+    r.median = 1E9 * median / r.made;
+    r.fastest = 1E9 * sorted[0] / r.made;
+    return r;
+}
+
+// First run of o.seed that does not stop before o.maxsteps
+template <class RNG>
+int findRun(const Options &o) {
+    for (int run = 0; run < 1000; run++) {
+        Simulator<RNG> simulator((int) o.maxsteps, o.seed, run, false);
+        CountingSink sink = { 0, 0.0 };
+        simulator.runSimulation(sink);
+        if (simulator.getLastStep() == o.maxsteps - 1) {
+            return run;
+        }
+    }
+    fprintf(stderr, "No run of seed %d reaches %lld steps, using run 0\n", o.seed, o.maxsteps);
+    return 0;
+}
+
+// Slope of the least squares line through (log made, log median time)
+static double exponent(const std::vector<Result> &results, const char* mode) {
+    double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+    int n = 0;
+    for (size_t k = 0; k < results.size(); k++) {
+        const Result &r = results[k];
+        if (strcmp(r.mode, mode) != 0) continue;
+        double x = log((double) r.made);
+        double y = log(r.median * r.made);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        n++;
+    }
+    if (n < 2) return NAN;
+    return (n * sxy - sx * sy) / (n * sxx - sx * sx);
+}
+
+static void writeJson(const Options &o, const std::vector<Result> &results,
+                      const std::vector<const char*> &modes) {
+    FILE *ofp = fopen(o.json, "w");
+
+    if (ofp == NULL) {
+      fprintf(stderr, "Can't open output file %s!\n",
+              o.json);
+      exit(1);
+    }
+
+    fprintf(ofp, "{\n  \"rng\": \"%s\",\n  \"seed\": %d,\n  \"run\": %d,\n  \"repeats\": %d,\n",
+            o.rng, o.seed, o.run, o.repeats);
+    fprintf(ofp, "  \"exponent\": {");
+    for (size_t m = 0; m < modes.size(); m++) {
+        double e = exponent(results, modes[m]);
+        fprintf(ofp, "%s\"%s\": ", m ? ", " : "", modes[m]);
+        if (!isfinite(e)) {
+            fprintf(ofp, "null");
+        } else {
+            fprintf(ofp, "%.4f", e);
+        }
+    }
+    fprintf(ofp, "},\n  \"results\": [\n");
+    for (size_t k = 0; k < results.size(); k++) {
+        const Result &r = results[k];
+        fprintf(ofp, "    {\"mode\": \"%s\", \"steps\": %d, \"made\": %d, \"ns_per_step_median\": %.3f, "
+                     "\"ns_per_step_min\": %.3f, \"memory_bytes\": %.0f, \"held_bytes\": %.0f, \"seconds\": [",
+                r.mode, r.steps, r.made, r.median, r.fastest, r.memory, r.held);
+        for (size_t j = 0; j < r.seconds.size(); j++) {
+            fprintf(ofp, "%s%.6e", j ? ", " : "", r.seconds[j]);
+        }
+        fprintf(ofp, "]}%s\n", k + 1 < results.size() ? "," : "");
+    }
+    fprintf(ofp, "  ]\n}\n");
+    fclose(ofp);
+}
+
+template <class RNG>
+int bench(Options o) {
+    if (o.run < 0) {
+        o.run = findRun<RNG>(o);
+    }
+    std::vector<const char*> modes;
+    bool all = strcmp(o.mode, "all") == 0;
+    bool both = strcmp(o.mode, "both") == 0;
+    if (all || both || strcmp(o.mode, "stream") == 0) modes.push_back("stream");
+    if (all || both || strcmp(o.mode, "full") == 0) modes.push_back("full");
+    if (all || strcmp(o.mode, "lambda") == 0) modes.push_back("lambda");
+
+    printf("Simulator scaling, %d repeats of realization (seed %d, run %d, %s):\n",
+           o.repeats, o.seed, o.run, o.rng);
+    printf("%-8s%12s%12s%14s%14s%14s%14s\n", "mode", "steps", "made", "ns/step", "fastest", "memory/MB", "held/MB");
+    std::vector<Result> results;
+    for (size_t m = 0; m < modes.size(); m++) {
+        for (long long steps = o.minsteps; steps <= o.maxsteps; steps *= 10) {
+            Result r = strcmp(modes[m], "lambda") == 0 ? measure<RNG, LambdaColumns>(o, modes[m], (int) steps)
+                                                       : measure<RNG, AllColumns>(o, modes[m], (int) steps);
+            printf("%-8s%12d%12d%14.2f%14.2f%14.2f%14.2f\n", r.mode, r.steps, r.made,
+                   r.median, r.fastest, r.memory / 1048576.0, r.held / 1048576.0);
+            fflush(stdout);
+            results.push_back(r);
+        }
+    }
+    for (size_t m = 0; m < modes.size(); m++) {
+        printf("Scaling exponent (%s): %.3f\n", modes[m], exponent(results, modes[m]));
+    }
+    if (o.json != NULL) {
+        writeJson(o, results, modes);
+        printf("Wrote %s\n", o.json);
+    }
+    return 0;
+}
+
+int main(int argc, const char * argv[]) {
+    Options o;
+    o.minsteps = 1000;
+    o.maxsteps = 10000000;
+    o.repeats = 5;
+    o.seed = 1;
+    o.run = -1;
+    o.rng = "philox";
+    o.mode = "all";
+    o.json = NULL;
+    for (int k = 1; k < argc; k++) {
+        if (strcmp(argv[k], "--min-steps") == 0 && k + 1 < argc) {
+            o.minsteps = atoll(argv[++k]);
+        } else if (strcmp(argv[k], "--max-steps") == 0 && k + 1 < argc) {
+            o.maxsteps = atoll(argv[++k]);
+        } else if (strcmp(argv[k], "--repeats") == 0 && k + 1 < argc) {
+            o.repeats = atoi(argv[++k]);
+        } else if (strcmp(argv[k], "--seed") == 0 && k + 1 < argc) {
+            o.seed = atoi(argv[++k]);
+        } else if (strcmp(argv[k], "--run") == 0 && k + 1 < argc) {
+            o.run = atoi(argv[++k]);
+        } else if (strcmp(argv[k], "--rng") == 0 && k + 1 < argc) {
+            o.rng = argv[++k];
+        } else if (strcmp(argv[k], "--mode") == 0 && k + 1 < argc) {
+            o.mode = argv[++k];
+        } else if (strcmp(argv[k], "--json") == 0 && k + 1 < argc) {
+            o.json = argv[++k];
+        } else {
+            fprintf(stderr, "Usage: %s [--min-steps N] [--max-steps N] [--repeats R] [--seed S] [--run R]\n"
+                            "          [--rng philox|mersenne|mother|sfmt] [--mode stream|full|lambda|both|all] [--json FILE]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (o.minsteps < 2 || o.maxsteps > 2147483647LL || o.repeats < 1) {
+        fprintf(stderr, "Need 2 <= steps < 2^31 and at least one repeat\n");
+        return 1;
+    }
+    if (strcmp(o.mode, "stream") != 0 && strcmp(o.mode, "full") != 0 && strcmp(o.mode, "lambda") != 0 &&
+        strcmp(o.mode, "both") != 0 && strcmp(o.mode, "all") != 0) {
+        fprintf(stderr, "Unknown mode %s\n", o.mode);
+        return 1;
+    }
+
+    if (strcmp(o.rng, "philox") == 0)   return bench<CRandomPhilox>(o);
+    if (strcmp(o.rng, "mersenne") == 0) return bench<CRandomMersenne>(o);
+    if (strcmp(o.rng, "mother") == 0)   return bench<CRandomMother>(o);
+    if (strcmp(o.rng, "sfmt") == 0)     return bench<CRandomSFMT>(o);
+    fprintf(stderr, "Unknown generator %s\n", o.rng);
+    return 1;
+}
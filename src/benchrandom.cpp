@@ -0,0 +1,77 @@
+/*************************************************************************
+ *  Measures the throughput of the uniform and standard normal generators
+ *
+ *  Compilation:      make benchrandom
+ *
+ *  Execution:        ./benchrandom.out [Number of Draws]
+ *                    Example :
+ *                    ./benchrandom.out 10000000
+ *
+ *  Prints numbers per second together with the sample mean and
+ *  variance of every method, so a faster method can be checked for
+ *  being no worse.
+ *
+ *************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctime>
+#include "random.h"
+#include "ziggurat.h"
+#include "../../lib/randomc/sfmt.h"
+
+// Report rate and first two moments of n numbers drawn by f
+template<class F> void bench(const char* name, int n, F f) {
+    double s1 = 0.0, s2 = 0.0;
+    std::clock_t start = std::clock();
+    for (int i = 0; i < n; i++) {
+        double x = f();
+        s1 += x;
+        s2 += x * x;
+    }
+    double t = (std::clock() - start) / (double) CLOCKS_PER_SEC;
+    double mean = s1 / n;
+    printf("%-24s %12.4E numbers/s   mean=% .4E   var=%.6f\n",
+           name, n / t, mean, s2 / n - mean * mean);
+}
+
+int main(int argc, const char * argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 10000000;
+    printf("Drawing %d uniforms per generator:\n", n);
+    CRandomMersenne mersenne(1);
+    bench("CRandomMersenne", n, [&]() { return mersenne.Random(); });
+    CRandomMother mother(1);
+    bench("CRandomMother", n, [&]() { return mother.Random(); });
+    CRandomPhilox philox(1, 0, 0);
+    bench("CRandomPhilox", n, [&]() { return philox.Random(); });
+
+    // SFMT per kernel, one at a time and in blocks
+    const int BLOCK = 4096;
+    double block[BLOCK];
+    int pos = BLOCK;
+    char name[64];
+    for (int kernel = SFMT_KERNEL_SSE2; kernel <= SFMT_KERNEL_AVX512; kernel++) {
+        if (CRandomSFMT::SelectKernel(kernel) != kernel) continue;
+        CRandomSFMT sfmt(1);
+        snprintf(name, sizeof(name), "CRandomSFMT %s", CRandomSFMT::KernelName());
+        bench(name, n, [&]() { return sfmt.Random(); });
+        snprintf(name, sizeof(name), "CRandomSFMT %s Fill", CRandomSFMT::KernelName());
+        bench(name, n, [&]() {
+            if (pos == BLOCK) { sfmt.Fill(block, BLOCK); pos = 0; }
+            return block[pos++];
+        });
+    }
+    CRandomSFMT::SelectKernel(0);
+
+    printf("Drawing %d standard normals per method:\n", n);
+    CRandomMersenne gen(1);
+    bench("rndGaussian (Box-Muller)", n, [&]() { return rndGaussian(gen); });
+
+    gen.RandomInit(1);
+    bench("Ziggurat::next", n, [&]() { return Ziggurat::next(gen); });
+
+    gen.RandomInit(1);
+    GaussianBuffer buffer;
+    bench("GaussianBuffer::next", n, [&]() { return buffer.next(gen); });
+    return 0;
+}
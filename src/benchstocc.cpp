@@ -0,0 +1,210 @@
+/*************************************************************************
+ *  Measures the throughput of the samplers in the stocc library
+ *
+ *  Compilation:      make benchstocc
+ *
+ *  Execution:        ./benchstocc.out [Seconds per Method]
+ *                    Example :
+ *                    ./benchstocc.out 0.2
+ *
+ *  The lib/stocc test programs check the shape of each distribution;
+ *  this one times every sampling method of StochasticLib1, 2 and 3
+ *  (inversion, mode search, ratio-of-uniforms, patchwork, urn, table)
+ *  for small and large means, together with the public function of each
+ *  class, which picks one of them from the parameters.
+ *
+ *  Every method is called directly, and only with parameters inside the
+ *  range its comments allow (e.g. inversion overflows for a Poisson mean
+ *  above 80, patchwork needs a mode of at least 10). Each row is run
+ *  twice: with fixed parameters, so the set-up a method caches for its
+ *  last parameters is done once, and with parameters cycling through 16
+ *  nearby values, so it is redone on every call. The rate is samples
+ *  per second of CPU time; the sample mean of the fixed run, next to the
+ *  exact mean where there is a simple formula, shows the method is not
+ *  fast by being wrong.
+ *
+ *************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctime>
+#include "../lib/randomc/randomc.h"    // before stocc.h, which would find the older copy in lib/stocc
+#include "../lib/stocc/stocc.h"
+
+#include "../lib/randomc/mersenne.cpp"
+#include "../lib/randomc/userintf.cpp"
+#include "../lib/stocc/stoc1.cpp"
+#include "../lib/stocc/stoc2.cpp"
+#include "../lib/stocc/stoc3.cpp"
+#include "../lib/stocc/fnchyppr.cpp"
+#include "../lib/stocc/wnchyppr.cpp"
+
+// The sampling methods are protected; these make them callable
+class Lib1 : public StochasticLib1 {
+public:
+    Lib1(int seed) : StochasticLib1(seed) {}
+    using StochasticLib1::PoissonInver;
+    using StochasticLib1::PoissonRatioUniforms;
+    using StochasticLib1::BinomialInver;
+    using StochasticLib1::BinomialRatioOfUniforms;
+    using StochasticLib1::HypInversionMod;
+    using StochasticLib1::HypRatioOfUnifoms;
+};
+
+class Lib2 : public StochasticLib2 {
+public:
+    Lib2(int seed) : StochasticLib2(seed) {}
+    using StochasticLib2::PoissonModeSearch;
+    using StochasticLib2::PoissonPatchwork;
+    using StochasticLib2::BinomialModeSearch;
+    using StochasticLib2::BinomialPatchwork;
+    using StochasticLib2::HypPatchwork;
+};
+
+class Lib3 : public StochasticLib3 {
+public:
+    Lib3(int seed) : StochasticLib3(seed) {}
+    using StochasticLib3::WalleniusNCHypUrn;
+    using StochasticLib3::WalleniusNCHypInversion;
+    using StochasticLib3::WalleniusNCHypTable;
+    using StochasticLib3::WalleniusNCHypRatioOfUnifoms;
+    using StochasticLib3::FishersNCHypInversion;
+    using StochasticLib3::FishersNCHypRatioOfUnifoms;
+};
+
+// number of parameter sets cycled through in the varying runs
+const int VARY = 16;
+
+// Samples per second of CPU time of f(k), called in blocks until
+// seconds have passed; k is 0 with fixed parameters, else 0..VARY-1
+template<class F> double rate(double seconds, bool vary, double &mean, F f) {
+    const int BLOCK = 1024;
+    double sum = 0.0;
+    long long n = 0;
+    std::clock_t start = std::clock();
+    double t = 0.0;
+    do {
+        for (int i = 0; i < BLOCK; i++) {
+            sum += f(vary ? i % VARY : 0);
+        }
+        n += BLOCK;
+        t = (std::clock() - start) / (double) CLOCKS_PER_SEC;
+    } while (t < seconds);
+    mean = sum / n;
+    return n / t;
+}
+
+// One row: fixed and varying parameters; exact < 0 if not known
+template<class F> void bench(double seconds, const char* lib, const char* method, double exact, F f) {
+    double mean, dummy;
+    double fixed = rate(seconds, false, mean, f);
+    double varying = rate(seconds, true, dummy, f);
+    printf("  %-6s %-20s %12.4E %12.4E   mean=%10.3f", lib, method, fixed, varying, mean);
+    if (exact >= 0.0) {
+        printf("  (exact %.3f)", exact);
+    }
+    printf("\n");
+}
+
+static void header(const char* title) {
+    printf("\n%s\n  %-6s %-20s %12s %12s\n", title, "class", "method", "fixed/s", "varying/s");
+}
+
+int main(int argc, const char * argv[]) {
+    double s = argc > 1 ? atof(argv[1]) : 0.2;
+    printf("Samples per second of CPU time, %g s per run, varying runs cycle %d parameter sets\n", s, VARY);
+    Lib1 lib1(1);
+    Lib2 lib2(1);
+    Lib3 lib3(1);
+
+    // Poisson(L); varying: L * (1 + k / 1000)
+    const double pmeans[] = { 5.0, 40.0, 1000.0 };
+    for (int r = 0; r < 3; r++) {
+        double L = pmeans[r];
+        char title[96];
+        snprintf(title, sizeof(title), "Poisson, mean %g", L);
+        header(title);
+        bench(s, "Lib1", "Poisson", L, [&](int k) { return lib1.Poisson(L * (1.0 + k / 1000.0)); });
+        bench(s, "Lib2", "Poisson", L, [&](int k) { return lib2.Poisson(L * (1.0 + k / 1000.0)); });
+        if (L < 80) {
+            bench(s, "Lib1", "inversion", L, [&](int k) { return lib1.PoissonInver(L * (1.0 + k / 1000.0)); });
+        }
+        if (L < 60) {
+            bench(s, "Lib2", "mode search", L, [&](int k) { return lib2.PoissonModeSearch(L * (1.0 + k / 1000.0)); });
+        }
+        bench(s, "Lib1", "ratio-of-uniforms", L, [&](int k) { return lib1.PoissonRatioUniforms(L * (1.0 + k / 1000.0)); });
+        if (L >= 10) {
+            bench(s, "Lib2", "patchwork", L, [&](int k) { return lib2.PoissonPatchwork(L * (1.0 + k / 1000.0)); });
+        }
+    }
+
+    // Binomial(n, p) with p < 0.5; varying: n + k
+    const int bn[] = { 100, 400, 10000 };
+    const double p = 0.05;
+    for (int r = 0; r < 3; r++) {
+        int n = bn[r];
+        double np = n * p;
+        char title[96];
+        snprintf(title, sizeof(title), "Binomial, n %d, p %g, mean %g", n, p, np);
+        header(title);
+        bench(s, "Lib1", "Binomial", np, [&](int k) { return lib1.Binomial(n + k, p); });
+        bench(s, "Lib2", "Binomial", np, [&](int k) { return lib2.Binomial(n + k, p); });
+        if (np < 60) {
+            bench(s, "Lib1", "inversion", np, [&](int k) { return lib1.BinomialInver(n + k, p); });
+            bench(s, "Lib2", "mode search", np, [&](int k) { return lib2.BinomialModeSearch(n + k, p); });
+        }
+        bench(s, "Lib1", "ratio-of-uniforms", np, [&](int k) { return lib1.BinomialRatioOfUniforms(n + k, p); });
+        if (np >= 10) {
+            bench(s, "Lib2", "patchwork", np, [&](int k) { return lib2.BinomialPatchwork(n + k, p); });
+        }
+    }
+
+    // Hypergeometric(n, m, N) with n <= m <= N/2; varying: N + 2k
+    const int hn[] = { 20, 60, 2000 };
+    const int hm[] = { 100, 250, 4000 };
+    const int hN[] = { 500, 500, 10000 };
+    for (int r = 0; r < 3; r++) {
+        int n = hn[r], m = hm[r], N = hN[r];
+        double mean = (double) n * m / N;
+        char title[96];
+        snprintf(title, sizeof(title), "Hypergeometric, n %d, m %d, N %d, mean %g", n, m, N, mean);
+        header(title);
+        bench(s, "Lib1", "Hypergeometric", mean, [&](int k) { return lib1.Hypergeometric(n, m, N + 2 * k); });
+        bench(s, "Lib2", "Hypergeometric", mean, [&](int k) { return lib2.Hypergeometric(n, m, N + 2 * k); });
+        if (N + 2 * VARY <= 680 && n <= 75) {
+            bench(s, "Lib1", "inversion", mean, [&](int k) { return lib1.HypInversionMod(n, m, N + 2 * k); });
+        }
+        bench(s, "Lib1", "ratio-of-uniforms", mean, [&](int k) { return lib1.HypRatioOfUnifoms(n, m, N + 2 * k); });
+        if (mean >= 10) {
+            bench(s, "Lib2", "patchwork", mean, [&](int k) { return lib2.HypPatchwork(n, m, N + 2 * k); });
+        }
+    }
+
+    // Noncentral hypergeometric(n, m, N, odds) with n <= m <= N/2; varying: N + 2k
+    const int wn[] = { 20, 2000 };
+    const int wm[] = { 50, 4000 };
+    const int wN[] = { 100, 10000 };
+    const double odds = 2.0;
+    for (int r = 0; r < 2; r++) {
+        int n = wn[r], m = wm[r], N = wN[r];
+        char title[96];
+        snprintf(title, sizeof(title), "Wallenius noncentral hypergeometric, n %d, m %d, N %d, odds %g", n, m, N, odds);
+        header(title);
+        bench(s, "Lib3", "WalleniusNCHyp", -1.0, [&](int k) { return lib3.WalleniusNCHyp(n, m, N + 2 * k, odds); });
+        bench(s, "Lib3", "urn", -1.0, [&](int k) { return lib3.WalleniusNCHypUrn(n, m, N + 2 * k, odds); });
+        if (n < 30) {
+            bench(s, "Lib3", "inversion", -1.0, [&](int k) { return lib3.WalleniusNCHypInversion(n, m, N + 2 * k, odds); });
+            bench(s, "Lib3", "table", -1.0, [&](int k) { return lib3.WalleniusNCHypTable(n, m, N + 2 * k, odds); });
+        }
+        bench(s, "Lib3", "ratio-of-uniforms", -1.0, [&](int k) { return lib3.WalleniusNCHypRatioOfUnifoms(n, m, N + 2 * k, odds); });
+
+        snprintf(title, sizeof(title), "Fisher's noncentral hypergeometric, n %d, m %d, N %d, odds %g", n, m, N, odds);
+        header(title);
+        bench(s, "Lib3", "FishersNCHyp", -1.0, [&](int k) { return lib3.FishersNCHyp(n, m, N + 2 * k, odds); });
+        if (n < 30 && N + 2 * VARY < 1024) {
+            bench(s, "Lib3", "inversion", -1.0, [&](int k) { return lib3.FishersNCHypInversion(n, m, N + 2 * k, odds); });
+        }
+        bench(s, "Lib3", "ratio-of-uniforms", -1.0, [&](int k) { return lib3.FishersNCHypRatioOfUnifoms(n, m, N + 2 * k, odds); });
+    }
+    return 0;
+}
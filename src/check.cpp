@@ -0,0 +1,375 @@
+/*************************************************************************
+ *  Checks parts of the simulator against results known to be right
+ *
+ *
+ *  Compilation:      make check
+ *
+ *  Execution:        ./check.out
+ *
+ *                    Prints one line per check and exits with 1 if
+ *                    any of them failed. It writes and removes
+ *                    check.bin and check.bin.pack in the working
+ *                    directory.
+ *
+ *  Dependencies:     VolumeEngine.h, QuantileSketch.h, BinaryTrajectory.h,
+ *                    Ensemble.h, random.h (randomc), ziggurat.h
+ *
+ *************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <algorithm>
+#include <vector>
+#include "random.h"
+#include "ziggurat.h"
+#include "../include/VolumeEngine.h"
+#include "../include/QuantileSketch.h"
+#include "../include/BinaryTrajectory.h"
+#include "../include/Ensemble.h"
+
+int failures = 0;
+
+// Report one check
+void report(const char* name, bool ok) {
+    printf("%-48s %s\n", name, ok ? "ok" : "FAILED");
+    if (!ok) failures++;
+}
+
+// Row i of the test trajectory, column j
+double cell(int i, int j) {
+    return i + j / 16.0;
+}
+
+/* Philox4x32-10 of counter 0 and key 0 against the known answer of
+ * Random123 (kat_vectors); CRandomPhilox(0, 0, 0) starts at that block */
+void checkPhilox() {
+    static const uint32_t expected[4] = { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 };
+    CRandomPhilox rng(0, 0, 0);
+    bool ok = true;
+    for (int k = 0; k < 4; k++) {
+        ok = ok && rng.BRandom() == expected[k];
+    }
+    report("Philox4x32-10 known answer, ctr=0 key=0", ok);
+}
+
+/* Jump(log2n) lands where 2^log2n calls to BRandom() do, from the
+ * start and after some draws */
+template <class RNG>
+bool checkJump(int log2n, int drawn) {
+    RNG stepped(12345), jumped(12345);
+    for (int i = 0; i < drawn; i++) {
+        stepped.BRandom();
+        jumped.BRandom();
+    }
+    for (long i = 0; i < 1L << log2n; i++) {
+        stepped.BRandom();
+    }
+    jumped.Jump(log2n);
+    for (int i = 0; i < 1000; i++) {
+        if (stepped.BRandom() != jumped.BRandom()) return false;
+    }
+    return true;
+}
+
+/* Split(n, log2spacing) gives the streams that start every
+ * 2^log2spacing outputs of the generator, so stream j is the block j
+ * of one long sequence and no two of them overlap; the generator
+ * itself goes on after the last one */
+template <class RNG>
+bool checkSplit(int n, int log2spacing) {
+    long spacing = 1L << log2spacing;
+    RNG reference(777), split(777);
+    std::vector<uint32_t> sequence((n + 1) * spacing);
+    for (size_t i = 0; i < sequence.size(); i++) {
+        sequence[i] = reference.BRandom();
+    }
+    std::vector<RNG> streams = split.Split(n, log2spacing);
+    if ((int) streams.size() != n) return false;
+    for (int j = 0; j < n; j++) {
+        for (long i = 0; i < spacing; i++) {
+            if (streams[j].BRandom() != sequence[j * spacing + i]) return false;
+        }
+    }
+    for (long i = 0; i < spacing; i++) {
+        if (split.BRandom() != sequence[n * spacing + i]) return false;
+    }
+    return true;
+}
+
+template <class RNG>
+void checkGenerator(const char* name, int minlog2n) {
+    char label[64];
+    bool ok = true;
+    for (int log2n = minlog2n; log2n <= 12; log2n++) {
+        ok = ok && checkJump<RNG>(log2n, 0) && checkJump<RNG>(log2n, 1001);
+    }
+    snprintf(label, sizeof(label), "%s Jump(k) = 2^k x BRandom(), k=%d..12", name, minlog2n);
+    report(label, ok);
+    snprintf(label, sizeof(label), "%s Split streams do not overlap", name);
+    report(label, checkSplit<RNG>(4, 11));
+}
+
+/* The O(1) moment shift of VolumeEngine against the exact O(n) sum
+ * sum_k (a_k y_k)^3 dt_k after every step, for a growing scale factor
+ * and random time steps */
+void checkVolumeEngine() {
+    const int n = 3000;
+    CRandomMersenne rng(4);
+    std::vector<double> a(n), dt(n), y(n, 0.0);
+    VolumeEngine engine;
+    double worst = 0.0;
+    for (int i = 0; i < n; i++) {
+        a[i] = 1.0 + 0.01 * i + 0.1 * rng.Random();
+        dt[i] = 1E-3 * (0.5 + rng.Random());
+        double v = engine.push(a[i], dt[i]);
+        double exact = 0.0;
+        for (int k = 0; k <= i; k++) {
+            y[k] += dt[i] / a[i];
+            exact += pow(a[k] * y[k], 3.0) * dt[k];
+        }
+        worst = fmax(worst, fabs(v - exact) / exact);
+    }
+    report("VolumeEngine against the exact sum", worst < 1E-12);
+}
+
+// relative difference of x from reference
+double relative(double x, double reference) {
+    return fabs(x - reference) / fabs(reference);
+}
+
+/* Statistics pushed all at once and merged from uneven parts against
+ * mean, variance, skewness and kurtosis from two passes in long double,
+ * for skewed data far from 0. The data itself is only good to 1E-10 of
+ * its spread there; sums of x and x^2 would miss the variance by 1E-3 */
+void checkStatistics() {
+    const int n = 20000;
+    const int cuts[] = { 0, 1, 3, 1000, 1001, 12345, n };
+    CRandomMersenne rng(5);
+    std::vector<double> x(n);
+    for (int i = 0; i < n; i++) {
+        double u = rng.Random();
+        x[i] = 1E6 + u * u * u;
+    }
+
+    long double sum = 0.0L;
+    for (int i = 0; i < n; i++) sum += x[i];
+    long double mean = sum / n, m2 = 0.0L, m3 = 0.0L, m4 = 0.0L;
+    for (int i = 0; i < n; i++) {
+        long double d = x[i] - mean;
+        m2 += d * d;
+        m3 += d * d * d;
+        m4 += d * d * d * d;
+    }
+    double variance = (double) (m2 / (n - 1));
+    double skewness = (double) (sqrtl(n) * m3 / powl(m2, 1.5L));
+    double kurtosis = (double) (n * m4 / (m2 * m2) - 3.0L);
+
+    Statistics single, merged;
+    for (int i = 0; i < n; i++) {
+        single.push(x[i]);
+    }
+    for (size_t c = 0; c + 1 < sizeof(cuts) / sizeof(cuts[0]); c++) {
+        Statistics part;
+        for (int i = cuts[c]; i < cuts[c + 1]; i++) {
+            part.push(x[i]);
+        }
+        merged.merge(part);
+    }
+
+    bool ok = true;
+    const Statistics* both[] = { &single, &merged };
+    for (int k = 0; k < 2; k++) {
+        const Statistics &s = *both[k];
+        ok = ok && s.getCount() == n && relative(s.getMean(), (double) mean) < 1E-14 &&
+             relative(s.getVariance(), variance) < 1E-9 && relative(s.getSkewness(), skewness) < 1E-8 &&
+             relative(s.getKurtosis(), kurtosis) < 1E-7;
+    }
+    report("Statistics push and merge against two passes", ok);
+}
+
+/* Mean, variance and the tail beyond 1, the start R = 3.4426 of the
+ * ziggurat's own tail and 4 of 10^6 ziggurat normals, within 5
+ * standard errors of the exact values */
+void checkZiggurat() {
+    const int n = 1000000;
+    const double t[] = { 1.0, 3.442619855899, 4.0 };
+    const int T = sizeof(t) / sizeof(t[0]);
+    CRandomMersenne rng(8);
+    double sum = 0.0, sum2 = 0.0;
+    long beyond[T] = { 0 };
+    for (int i = 0; i < n; i++) {
+        double x = Ziggurat::next(rng);
+        sum += x;
+        sum2 += x * x;
+        for (int k = 0; k < T; k++) {
+            if (fabs(x) > t[k]) beyond[k]++;
+        }
+    }
+    double mean = sum / n;
+    double variance = sum2 / n - mean * mean;
+    bool ok = fabs(mean) < 5.0 / sqrt(n) && fabs(variance - 1.0) < 5.0 * sqrt(2.0 / n);
+    for (int k = 0; k < T; k++) {
+        double p = erfc(t[k] / sqrt(2.0));
+        ok = ok && fabs(beyond[k] - n * p) < 5.0 * sqrt(n * p * (1.0 - p));
+    }
+    report("Ziggurat moments and tails", ok);
+}
+
+/* Quantiles of 4 merged sketches of 10^5 normal points against the
+ * sorted data: the rank of every estimate is within 1% of min(q, 1 - q)
+ * plus 20 points (the tails hold only a few points), min and max exact */
+void checkQuantileSketch() {
+    const int n = 100000;
+    const double qs[] = { 1E-4, 1E-3, 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999, 0.9999 };
+    CRandomMersenne rng(6);
+    std::vector<double> x(n);
+    QuantileSketch parts[4], total;
+    for (int i = 0; i < n; i++) {
+        x[i] = Ziggurat::next(rng);
+        parts[i % 4].push(x[i]);
+    }
+    for (int t = 0; t < 4; t++) {
+        total.merge(parts[t]);
+    }
+    std::sort(x.begin(), x.end());
+
+    bool ok = total.getCount() == n && total.getMin() == x[0] && total.getMax() == x[n - 1];
+    for (size_t k = 0; k < sizeof(qs) / sizeof(qs[0]); k++) {
+        double q = qs[k];
+        double rank = (std::lower_bound(x.begin(), x.end(), total.getQuantile(q)) - x.begin()) / (double) n;
+        ok = ok && fabs(rank - q) <= 0.01 * std::min(q, 1.0 - q) + 20.0 / n;
+    }
+    report("QuantileSketch rank error against a sort", ok);
+}
+
+// same bits, so NaN equals NaN
+bool same(double x, double y) {
+    return memcmp(&x, &y, sizeof(double)) == 0;
+}
+
+/* The statistics and quantiles of an ensemble are bit for bit the same
+ * on 1 and on 4 threads */
+bool checkEnsemble(int lanes) {
+    const int steps = 200, realizations = 300;
+    Ensemble<CRandomPhilox> one(steps, realizations, 1, 7, 20, lanes);
+    Ensemble<CRandomPhilox> four(steps, realizations, 4, 7, 20, lanes);
+    one.run();
+    four.run();
+    EnsembleReducer &a = one.getReducer(), &b = four.getReducer();
+    bool ok = same(one.getLastStep().getMean(), four.getLastStep().getMean());
+    for (int i = 0; ok && i < steps; i++) {
+        ok = a.getCount(i) == b.getCount(i) && same(a.getMean(i), b.getMean(i)) && same(a.getSdev(i), b.getSdev(i));
+        for (int k = 1; ok && k < 10; k++) {
+            ok = same(a.getQuantile(i, k / 10.0), b.getQuantile(i, k / 10.0));
+        }
+    }
+    return ok;
+}
+
+/* In a child process, write rows rows of the test trajectory into
+ * filename with room for steps rows; then close() it, which packs it,
+ * and exit, or kill the child if not */
+pid_t writeTrajectory(const char* filename, int steps, int chunk, int rows, bool close) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        fprintf(stderr, "Can't fork!\n");
+        exit(1);
+    }
+    if (pid > 0) return pid;
+
+    SimulatorParameters p;
+    memset(&p, 0, sizeof(p));
+    BinaryTrajectoryWriter writer(filename, steps, chunk, p, "check");
+    for (int i = 0; i < rows; i++) {
+        SimulatorState s;
+        double* x[] = { &s.tau, &s.lambda, &s.a, &s.N, &s.V, &s.S, &s.rhomat, &s.rhorad, &s.eta };
+        for (int j = 0; j < 9; j++) {
+            *x[j] = cell(i, j);
+        }
+        writer.record(i, s);
+    }
+    if (close) {
+        writer.close();
+        _exit(0);
+    }
+    kill(getpid(), SIGKILL);
+    return pid;
+}
+
+// filename holds the first rows rows of the test trajectory
+bool readTrajectory(const char* filename, int rows) {
+    BinaryTrajectory trajectory(filename);
+    bool ok = trajectory.getCount() == (uint64_t) rows && trajectory.getColumns() == 9;
+    for (int j = 0; ok && j < trajectory.getColumns(); j++) {
+        const double* x = trajectory.getColumn(j);
+        for (uint64_t i = 0; i < trajectory.getCount(); i++) {
+            ok = ok && x[i] == cell((int) i, j);
+        }
+    }
+    return ok;
+}
+
+/* A run killed while writing its binary trajectory leaves a file that
+ * reads back up to the last chunk it completed */
+void checkInterruptedTrajectory() {
+    const char* filename = "check.bin";
+    const int steps = 1000, chunk = 100, killed = 250;
+
+    int status;
+    waitpid(writeTrajectory(filename, steps, chunk, killed, false), &status, 0);
+    bool ok = readTrajectory(filename, killed / chunk * chunk);
+    unlink(filename);
+    report("binary trajectory after SIGKILL", ok);
+}
+
+/* A run killed while close() packs its binary trajectory leaves the
+ * whole unpacked file. The child is killed as soon as the packed copy
+ * appears; if it got to the end anyway, try again. */
+void checkInterruptedPack() {
+    const char* filename = "check.bin";
+    const char* packedFilename = "check.bin.pack";
+    const int steps = 200000, chunk = 1000, rows = 150000;
+
+    bool inside = false, ok = true;
+    for (int attempt = 0; ok && !inside && attempt < 5; attempt++) {
+        unlink(packedFilename);
+        pid_t pid = writeTrajectory(filename, steps, chunk, rows, true);
+        int status;
+        while (access(packedFilename, F_OK) != 0 && waitpid(pid, &status, WNOHANG) == 0) {
+        }
+        kill(pid, SIGKILL);
+        waitpid(pid, &status, 0);
+        inside = access(packedFilename, F_OK) == 0;
+        ok = readTrajectory(filename, rows);
+    }
+    unlink(packedFilename);
+    unlink(filename);
+    report("binary trajectory after SIGKILL in pack()", ok && inside);
+}
+
+int main() {
+    checkVolumeEngine();
+    checkStatistics();
+    checkQuantileSketch();
+    checkZiggurat();
+    checkPhilox();
+    checkGenerator<CRandomMersenne>("Mersenne", 0);
+    // SFMT jumps by whole 128-bit words
+    checkGenerator<CRandomSFMT>("SFMT", 2);
+    checkInterruptedTrajectory();
+    checkInterruptedPack();
+    report("Ensemble on 1 and 4 threads", checkEnsemble(1));
+    report("Ensemble on 1 and 4 threads, 4 lanes", checkEnsemble(4));
+
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
@@ -7,13 +7,64 @@
  *
  *  Compilation:      g++ main.cpp -o main.o
  *
- *  Execution:        ./main.o [Number of Steps]
+ *  Execution:        ./main.o [Number of Steps] [--check-volume] [--seed S]
+ *                           [--run K] [--realizations R] [--threads T]
+ *                           [--quantile-steps M] [--lanes W]
+ *                           [--alphas A1,A2,...]
+ *                           [--set NAME=X] [--grid NAME=LO:HI:N]
+ *                           [--log-grid NAME=LO:HI:N] [--lhs M]
+ *                           [--config FILE]
+ *                           [--stream [--chunk K]] [--binary] [--async]
+ *                           [--perf] [--trace FILE]
  *                    Example : 
  *                    ./main.o 1000
+ *                    ./main.o 1000 --realizations 5000 --threads 8
+ *
+ *                    Without other options the steps are kept in
+ *                    memory, only tau (implicit) and lambda unless
+ *                    --check-volume, which recomputes every volume with
+ *                    the exact O(N^2) loop and prints the largest
+ *                    deviation.
+ *                    --realizations runs R independent realizations on
+ *                    T threads and writes the per-step mean and sdev of
+ *                    lambda to lambda-ensemble.txt, and quantiles of
+ *                    lambda for M steps (--quantile-steps M, default
+ *                    100) to lambda-quantiles.txt.
+ *                    --lanes W runs the realizations W = 4 or 8 at a
+ *                    time in the lanes of AVX2 or AVX-512 registers
+ *                    (0: the widest the CPU has; see LaneSimulator.h).
+ *                    --alphas runs realization (seed, run) for every
+ *                    alpha (ell = alpha * LPLANCK) with the same noise
+ *                    and writes lambda of all of them to
+ *                    lambda-alpha.txt (see AlphaSweep.h).
+ *                    --set fixes a model parameter (a0, tau0,
+ *                    deltatau, rhomat0, rhorad0, lambda0 or alpha)
+ *                    for any of the runs here. --grid and --log-grid
+ *                    sweep one over N values instead, --lhs M picks
+ *                    M latin hypercube points over the grid ranges;
+ *                    the points run as jobs on T threads and one row
+ *                    per point goes to lambda-grid.txt. --config
+ *                    reads the same options from FILE, one per line
+ *                    without the dashes (see ParameterGrid.h).
+ *                    --run K regenerates realization K of an ensemble
+ *                    with the same seed.
+ *                    --rng picks the uniform generator (default mersenne).
+ *                    --stream writes every step to trajectory.txt in
+ *                    chunks of K rows (default 65536) while running,
+ *                    with constant memory in the number of steps.
+ *                    --binary streams to trajectory.bin in the binary
+ *                    columnar format instead (see BinaryTrajectory.h);
+ *                    trajectory2txt.out turns it into lambda.txt.
+ *                    --async does the writing of --stream and --binary
+ *                    on a separate thread.
+ *                    At exit a report of the Timer regions is printed;
+ *                    --perf adds hardware counters to it, --trace FILE
+ *                    writes the regions of all threads as a Chrome
+ *                    trace (chrome://tracing, ui.perfetto.dev).
  *
  *  Dependencies:     None
  *
- *  Third party:      mersenne.cpp
+ *  Third party:      randomc (mersenne, mother, sfmt, philox)
  *
  *  User parameters:  N    - number of steps in the simulation
  *
@@ -22,210 +73,341 @@
 #include <stdio.h>
 //#include <cstdlib>
 #include <stdlib.h>
+#include <limits.h>
 #include <string.h>
 #include <cmath>
 #include <math.h>
 #include <ctime>
-#include "random.h"
+#include <random>
+#include <thread>
+#include "../include/Simulator.h"
+#include "../include/Ensemble.h"
+#include "../include/AlphaSweep.h"
+#include "../include/ParameterGrid.h"
+#include "../include/ParameterScan.h"
+#include "../include/TrajectoryWriter.h"
+#include "../include/BinaryTrajectory.h"
+#include "../include/AsyncWriter.h"
 
 // THIS IS A RANDOM ORANGE
 
-// SI UNITS AND CONSTANTS
-const double PI = M_PI;
-double HBAR    = 1.05457173E-34; // m^2 * kg / s
-//double HBAR    = 1.0;
-double CLIGHT  = 299792458.0;    // m / s
-//double CLIGHT  = 1.0;
-double GNEWTON = 6.67384E-11;    // m^3 / kg / s^2
-//double GNEWTON = 1.0;
-double LPLANCK = pow(8.0 * PI * GNEWTON * HBAR / pow(CLIGHT, 3.0), 0.5);
-//double LPLANCK = 1.0;
-double TPLANCK = pow(8.0 * PI * GNEWTON * HBAR / pow(CLIGHT, 5.0), 0.5);
-//double TPLANCK = 1.0;
-double KAPPA = 8.0 * PI * GNEWTON * pow(CLIGHT, -4.0); // TIME^2 / MASS / LENGTH
-double AGEOFUNIVERSE = 4.3E17;   // s
-double HUBBLE0 = 2.20E-18;       // 1 / s
-
-// Simulator Class
-class Simulator {
-
-private:
-    // RNG
-    //CRandomMersenne *RanGen;
-
-    // number of steps
+// Command line options
+struct Options {
     int steps;
+    bool checkvolume;
+    int seed;
+    int run;
+    int realizations;
+    int threads;
+    int quantilesteps;
+    int lanes;
+    std::vector<double> alphas;
+    SimulatorParameters params;     // model parameters, with seed and run
+    ParameterGrid grid;
+    const char* rng;
+    bool stream;
+    bool binary;
+    bool async;
+    bool perf;
+    const char* trace;
+    int chunk;
+};
 
-    // free parameter ell
-    double ell;
-
-    // variable vectors
-    double* a;          // scale factor
-    double* N;          // number of atoms
-    double* V;          // volume
-    double* y;          // temp variables sum_k^i(dt/a) used to speed up volume calculation
-    double* S;          // action
-    double* rhomat;     // matter energy density
-    double* rhorad;     // radiation energy density
-    double* lambda;     // lambda
-    double* tau;        // proper time (along isotropic worldlines)
-    double* debug;      // array used for debugging;
-
-    // initial conditions and model parameters
-    double a0;          // initial scale factor
-    double tau0;        // initial time
-    double deltatau;    // time increment (if constant)
-    double V0;          // initial volume
-    double rhomat0;     // initial matter energy density
-    double rhorad0;     // initial radiation energy density
-    double lambda0;     // initial dark energy density
-    int ifinish;        // final step value when root becomes negative
-
-public:
-    // Class constructor
-    Simulator(int steps) {
-        this->initialize(steps);
-    }
-
-    // Class destructor
-    ~Simulator() {
-        delete a;
-        delete N;
-        delete V;
-        delete S;
-        delete rhomat;
-        delete rhorad;
-        delete lambda;
-        delete tau;
-        delete debug;
-    }
-
-public:
-    void runSimulation() {
-        for (int i = 0; i < steps; i++) {
-            doStep(i);
-            if((rhorad[i] + rhomat[i] + lambda[i] / KAPPA) * 8.0 * PI * GNEWTON * pow(CLIGHT, -2.0) / 3.0<0){
-                break;
-            }
-            //printf("%d: tau=%E a=%E rhorad=%E rhomat=%E rhoratio=%E root=%E\n", i, tau[i], a[i], rhorad[i], rhomat[i], (lambda[i] / KAPPA) / 5.36934E-10 , (rhorad[i] + rhomat[i] + lambda[i] / KAPPA) * 8.0 * PI * GNEWTON * pow(CLIGHT, -2.0) / 3.0);
-        }
-        printf("Managed %i steps\n" , ifinish);
-        printf("%d: tau=%E a=%E rhorad=%E rhomat=%E rhoratio=%E root=%E\n", ifinish, tau[ifinish], a[ifinish], rhorad[ifinish], rhomat[ifinish], (lambda[ifinish] / KAPPA) / 5.36934E-10 , (rhorad[ifinish] + rhomat[ifinish] + lambda[ifinish] / KAPPA) * 8.0 * PI * GNEWTON * pow(CLIGHT, -2.0) / 3.0);
-        this->getLuminosityDistances();
-    }
-
-    void doStep(int i) {
-        ifinish = i;
-        // New scale factor
-        //double root = (rhorad[i] + rhomat[i]) * (8.0 * PI * GNEWTON * pow(CLIGHT, -2.0)) / 3.0;
-        double root = (rhorad[i] + rhomat[i] + lambda[i] / KAPPA) * 8.0 * PI * GNEWTON * pow(CLIGHT, -2.0) / 3.0;
-        a[i + 1] = a[i] * (1.0 + sqrt(root) * (tau[i + 1] - tau[i]));
-
-        // New volume (double checked)
-        V[i + 1] = 0.0;
-        for(int k = 0; k < i + 1; k++) {
-            y[k] += (tau[i + 1] - tau[i]) / a[i];
-            V[i + 1] += pow(a[k] * y[k], 3.0) * (tau[k + 1] - tau[k]);
-        }
-        V[i + 1] = pow(CLIGHT, 4.0) * 4.0 * PI / 3.0 * V[i + 1];
-
-        // New Cardinality
-        N[i + 1] = V[i + 1] / pow(ell, 4.0);
+// Run simulator into sink, on the calling thread or through an AsyncWriter
+template <class RNG, class Sink>
+void stream(Simulator<RNG> &simulator, Sink &sink, const Options &o) {
+    if (o.async) {
+        AsyncWriter<Sink> async(sink, o.chunk);
+        simulator.runSimulation(async);
+        async.close();
+    } else {
+        simulator.runSimulation(sink);
+    }
+}
 
-        // New Action
-        S[i + 1] = S[i] + rndGaussian() * sqrt(N[i + 1] - N[i]) * HBAR;
+// Run realization (seed, run) for every alpha in o.alphas, W alphas per vector step
+template <class RNG, int W>
+void sweep(const Options &o) {
+    AlphaSweep<RNG, W> sweep(o.steps, o.seed, o.run, o.params, o.alphas);
+    AlphaSweepWriter writer("lambda-alpha.txt", o.alphas);
+    sweep.runSimulation(writer);
+    writer.close();
+    for (int k = 0; k < sweep.getCount(); k++) {
+        printf("alpha=%g: managed %d steps\n", sweep.getAlpha(k), sweep.getLastStep(k));
+    }
+}
 
-        // New lambda
-        lambda[i + 1] = CLIGHT * KAPPA * S[i + 1] / V[i + 1];
+// Run realization (seed, run) keeping the steps in memory, only the
+// columns of policy Columns, and write lambda.txt
+template <class RNG, class Columns>
+void keep(const Options &o) {
+    Simulator<RNG, Columns>* simulator = new Simulator<RNG, Columns>(o.steps, o.params, o.checkvolume);
+    simulator->runSimulation();
+    simulator->printSummary();
+    {
+        TimerRegion output("output");
+        simulator->printToFile();
+    }
+    delete simulator;
+}
 
-        // New rho
-        rhomat[i + 1] = rhomat0 * pow(a[0] / a[i + 1], 3.0);
-        rhorad[i + 1] = rhorad0 * pow(a[0] / a[i + 1], 4.0);
+// Run every point of o.grid on the realization (seed, run)
+template <class RNG>
+void scan(const Options &o) {
+    ParameterScan<RNG> scan(o.steps, o.grid.expand(o.params), o.threads);
+    printf("Scanning %d parameter sets", scan.getCount());
+    for (int d = 0; d < o.grid.getAxes(); d++) {
+        printf("%s%s", d ? ", " : " over ", ParameterGrid::name(o.grid.getParameter(d)));
+    }
+    printf(" for %d steps on %d threads (seed %d, run %d, %s)\n", o.steps, o.threads, o.seed, o.run, o.rng);
+    scan.run();
+    {
+        TimerRegion output("output");
+        scan.printToFile("lambda-grid.txt");
+    }
+    int full = 0;
+    for (int k = 0; k < scan.getCount(); k++) {
+        full += scan.getResult(k).laststep == o.steps - 1;
     }
+    printf("%d of %d parameter sets managed all steps\n", full, scan.getCount());
+}
 
-        void printToFile() {
-        FILE *ofp;
-        char outputFilename[] = "lambda.txt";
-        ofp = fopen(outputFilename, "w");
+// Run a single realization, an alpha sweep, an ensemble or a parameter scan with generator RNG
+template <class RNG>
+int simulate(const Options &o) {
+    TimerRegion region("simulate");
+    if (!o.grid.empty()) {
+        scan<RNG>(o);
+        return 0;
+    }
 
-        if (ofp == NULL) {
-          fprintf(stderr, "Can't open output file %s!\n",
-                  outputFilename);
-          exit(1);
+    if (!o.alphas.empty()) {
+        printf("Sweeping %d values of alpha for %d steps with common noise (seed %d, run %d, %s):\n",
+               (int) o.alphas.size(), o.steps, o.seed, o.run, o.rng);
+        if (o.lanes == 8) {
+            sweep<RNG, 8>(o);
+        } else if (o.lanes == 4) {
+            sweep<RNG, 4>(o);
+        } else {
+            sweep<RNG, 1>(o);
         }
+        return 0;
+    }
 
-        for(int i = 0; i < steps; i++) {
-            fprintf(ofp, "%E\t%E\n", tau[i], lambda[i]);
+    if (o.realizations > 0) {
+        printf("Running %d realizations of %d steps on %d threads (seed %d, %s):\n", o.realizations, o.steps, o.threads, o.seed, o.rng);
+        if (o.lanes > 1) {
+            printf("%d lanes per thread (%s)\n", o.lanes, 
+                   o.lanes == 8 ? LaneSimulator<RNG, 8>::kernelName() : LaneSimulator<RNG, 4>::kernelName());
+        }
+        Ensemble<RNG> ensemble(o.steps, o.realizations, o.threads, o.seed, o.quantilesteps, o.lanes, o.params);
+        ensemble.run();
+        {
+            TimerRegion output("output");
+            ensemble.printToFile("lambda-ensemble.txt");
+            const double qs[] = { 0.05, 0.25, 0.5, 0.75, 0.95 };
+            ensemble.getReducer().printQuantilesToFile("lambda-quantiles.txt", qs, 5);
         }
+        Statistics &last = ensemble.getLastStep();
+        printf("Last step reached: mean %.1f, 5%% %.0f, median %.0f, 95%% %.0f\n", last.getMean(),
+               last.getQuantile(0.05), last.getMedian(), last.getQuantile(0.95));
+        return 0;
     }
 
-private:
-    void initialize(int steps) {
-        // Set number of steps
-        this->steps = steps;
-
-        // Set free parameter ell
-        double alpha = 2.5;
-        ell = alpha * LPLANCK;
-
-        // Set initial values
-        //deltatau = (AGEOFUNIVERSE / TPLANCK) / steps;
-        deltatau = 1.0;
-        printf("delta-tau = %E\n", deltatau);
-        tau0 = 1;
-        //tau0 = TPLANCK;
-        a0 = 1.99716E-10;
-        V0 = 0.0;
-        rhomat0 = 2.98428E19; //DIMENSIONFUL!
-        rhorad0 = 4.01871E25; //DIMENSIONFUL!
-        lambda0 = 0.0;
-        ifinish = 0;
-
-        // Allocate memory
-        a =      new double[steps];
-        N =      new double[steps];
-        V =      new double[steps];
-        y =      new double[steps];
-        S =      new double[steps];
-        rhomat = new double[steps];
-        rhorad = new double[steps];
-        lambda = new double[steps];
-        tau =    new double[steps];
-        debug =  new double[steps];
-
-        // Initialise vectors
-        a[0] = a0;
-        lambda[0] = lambda0;
-        rhomat[0] = rhomat0;
-        rhorad[0] = rhorad0;
-        tau[0] = tau0;
-        V[0] = V0;
-        N[0] = V0 / pow(ell, 4.0);
-        S[0] = 0.0;
-        for (int i = 1; i < steps; i++) {
-            tau[i] = tau0 + i * deltatau;
-            y[i] = 0.0;
-        }
-        debug[0] = 0.0;
+    if (o.binary) {
+        printf("Streaming simulation for %d steps to trajectory.bin (seed %d, run %d, %s):\n", o.steps, o.seed, o.run, o.rng);
+        Simulator<RNG> simulator(o.steps, o.params, false);
+        BinaryTrajectoryWriter writer("trajectory.bin", o.steps, o.chunk, simulator.getParameters(), o.rng);
+        stream(simulator, writer, o);
+        writer.close();
+        simulator.printSummary();
+        return 0;
+    }
 
-        // Seed RNG
-        InitRandom();
+    if (o.stream) {
+        printf("Streaming simulation for %d steps to trajectory.txt (seed %d, run %d, %s):\n", o.steps, o.seed, o.run, o.rng);
+        Simulator<RNG> simulator(o.steps, o.params, false);
+        TrajectoryWriter writer("trajectory.txt", o.chunk);
+        stream(simulator, writer, o);
+        writer.close();
+        simulator.printSummary();
+        return 0;
     }
 
-    double* getLuminosityDistances() {
-        double* out = new double[steps];
-        for(int i = 0; i < steps; i++) {
-            out[i] = a[steps - 1] * y[i] / a[i];
-        }
-        return out;
-    } 
-};
+    printf("Running simulation for %d steps (seed %d, run %d, %s):\n", o.steps, o.seed, o.run, o.rng);
+    if (o.checkvolume) {
+        keep<RNG, AllColumns>(o);
+    } else {
+        keep<RNG, LambdaColumns>(o);
+    }
+    return 0;
+}
+
+// Parse the value of option name as a whole int of at least low
+static bool parseInt(const char* name, const char* arg, long low, int* value) {
+    char* rest;
+    long v = strtol(arg, &rest, 10);
+    if (rest == arg || *rest != '\0' || v < INT_MIN || v > INT_MAX) {
+        fprintf(stderr, "%s needs an integer, not %s\n", name, arg);
+        return false;
+    }
+    if (v < low) {
+        fprintf(stderr, "%s needs an integer of at least %ld, not %s\n", name, low, arg);
+        return false;
+    }
+    *value = (int) v;
+    return true;
+}
 
 int main(int argc, const char * argv[]) {
-    int steps = atoi(argv[1]);
-    printf("Running simulation for %d steps:\n", steps);
-    Simulator* simulator = new Simulator(steps);
-    simulator->runSimulation();
-    simulator->printToFile();
-    return 0;
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s steps [--check-volume] [--seed S] [--run K] [--realizations R --threads T [--quantile-steps M] [--lanes W]]\n"
+                        "          [--alphas A1,A2,...] [--set NAME=X] [--grid NAME=LO:HI:N] [--log-grid NAME=LO:HI:N]\n"
+                        "          [--lhs M] [--config FILE]\n"
+                        "          [--rng mersenne|mother|sfmt|philox] [--stream [--chunk K]] [--binary] [--async]\n"
+                        "          [--perf] [--trace FILE]\n", argv[0]);
+        return 1;
+    }
+    Options o;
+    char* rest;
+    long steps = strtol(argv[1], &rest, 10);
+    if (rest == argv[1] || *rest != '\0' || steps < 2 || steps > INT_MAX) {
+        fprintf(stderr, "Need a number of at least 2 steps, not %s\n", argv[1]);
+        return 1;
+    }
+    o.steps = (int) steps;
+    o.params = defaultParameters();
+    o.checkvolume = false;
+    // not time(0): runs started in the same second would share their noise
+    o.seed = (int) std::random_device()();
+    o.run = 0;
+    o.realizations = 0;
+    o.threads = std::thread::hardware_concurrency();
+    o.quantilesteps = 100;
+    o.lanes = 1;
+    o.rng = "mersenne";
+    o.stream = false;
+    o.binary = false;
+    o.async = false;
+    o.perf = false;
+    o.trace = NULL;
+    o.chunk = 65536;
+    for (int k = 2; k < argc; k++) {
+        if (strcmp(argv[k], "--check-volume") == 0) {
+            o.checkvolume = true;
+        } else if (strcmp(argv[k], "--seed") == 0 && k + 1 < argc) {
+            if (!parseInt(argv[k], argv[k + 1], INT_MIN, &o.seed)) {
+                return 1;
+            }
+            k++;
+        } else if (strcmp(argv[k], "--run") == 0 && k + 1 < argc) {
+            if (!parseInt(argv[k], argv[k + 1], 0, &o.run)) {
+                return 1;
+            }
+            k++;
+        } else if (strcmp(argv[k], "--realizations") == 0 && k + 1 < argc) {
+            if (!parseInt(argv[k], argv[k + 1], 1, &o.realizations)) {
+                return 1;
+            }
+            k++;
+        } else if (strcmp(argv[k], "--threads") == 0 && k + 1 < argc) {
+            if (!parseInt(argv[k], argv[k + 1], 1, &o.threads)) {
+                return 1;
+            }
+            k++;
+        } else if (strcmp(argv[k], "--quantile-steps") == 0 && k + 1 < argc) {
+            if (!parseInt(argv[k], argv[k + 1], 1, &o.quantilesteps)) {
+                return 1;
+            }
+            k++;
+        } else if (strcmp(argv[k], "--lanes") == 0 && k + 1 < argc) {
+            if (!parseInt(argv[k], argv[k + 1], 1, &o.lanes)) {
+                return 1;
+            }
+            k++;
+        } else if (strcmp(argv[k], "--alphas") == 0 && k + 1 < argc) {
+            // comma separated list
+            char* end;
+            for (const char* a = argv[++k]; *a; a = *end ? end + 1 : end) {
+                o.alphas.push_back(strtod(a, &end));
+                if (end == a || (*end != ',' && *end != '\0')) {
+                    fprintf(stderr, "Bad alpha list %s\n", argv[k]);
+                    return 1;
+                }
+                if (!(o.alphas.back() > 0.0)) {
+                    fprintf(stderr, "alpha must be positive, not %g in %s\n", o.alphas.back(), argv[k]);
+                    return 1;
+                }
+            }
+        } else if ((strcmp(argv[k], "--set") == 0 || strcmp(argv[k], "--grid") == 0 ||
+                    strcmp(argv[k], "--log-grid") == 0 || strcmp(argv[k], "--lhs") == 0) && k + 1 < argc) {
+            const char* key = argv[k] + 2;
+            if (!o.grid.parse(key, argv[++k], o.params)) {
+                return 1;
+            }
+        } else if (strcmp(argv[k], "--config") == 0 && k + 1 < argc) {
+            if (!o.grid.readConfig(argv[++k], o.params)) {
+                return 1;
+            }
+        } else if (strcmp(argv[k], "--rng") == 0 && k + 1 < argc) {
+            o.rng = argv[++k];
+        } else if (strcmp(argv[k], "--stream") == 0) {
+            o.stream = true;
+        } else if (strcmp(argv[k], "--binary") == 0) {
+            o.binary = true;
+        } else if (strcmp(argv[k], "--async") == 0) {
+            o.async = true;
+        } else if (strcmp(argv[k], "--perf") == 0) {
+            o.perf = true;
+        } else if (strcmp(argv[k], "--trace") == 0 && k + 1 < argc) {
+            o.trace = argv[++k];
+        } else if (strcmp(argv[k], "--chunk") == 0 && k + 1 < argc) {
+            if (!parseInt(argv[k], argv[k + 1], 1, &o.chunk)) {
+                return 1;
+            }
+            k++;
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[k]);
+            return 1;
+        }
+    }
+
+    o.params.seed = o.seed;
+    o.params.run = o.run;
+    if (!o.grid.check()) {
+        return 1;
+    }
+    if (!o.grid.empty() && (o.realizations > 0 || !o.alphas.empty() || o.stream || o.binary || o.checkvolume)) {
+        fprintf(stderr, "--grid and --lhs run one realization per point and can't be combined with\n"
+                        "--realizations, --alphas, --stream, --binary or --check-volume\n");
+        return 1;
+    }
+
+    if ((o.stream || o.binary) && o.checkvolume) {
+        fprintf(stderr, "--check-volume needs the full trajectory and can't be used with --stream\n");
+        return 1;
+    }
+
+    if (o.lanes == 0) {
+        o.lanes = widestLanes();
+    }
+    if (o.lanes != 1 && o.lanes != 4 && o.lanes != 8) {
+        fprintf(stderr, "--lanes must be 1, 4 or 8\n");
+        return 1;
+    }
+
+    if (o.perf) {
+        Timer::enableCounters();
+    }
+    if (o.trace != NULL) {
+        Timer::enableTrace(o.trace);
+    }
+
+    // one instantiation per generator, picked at run time
+    if (strcmp(o.rng, "philox") == 0)   return simulate<CRandomPhilox>(o);
+    if (strcmp(o.rng, "mersenne") == 0) return simulate<CRandomMersenne>(o);
+    if (strcmp(o.rng, "mother") == 0)   return simulate<CRandomMother>(o);
+    if (strcmp(o.rng, "sfmt") == 0)     return simulate<CRandomSFMT>(o);
+    fprintf(stderr, "Unknown generator %s\n", o.rng);
+    return 1;
 }
@@ -0,0 +1,104 @@
+/*************************************************************************
+ *  Converts a binary trajectory file to the text formats of main
+ *
+ *
+ *  Compilation:      make trajectory2txt
+ *
+ *  Execution:        ./trajectory2txt.out input.bin [output.txt] [--all] [--info]
+ *                    Example :
+ *                    ./trajectory2txt.out trajectory.bin lambda.txt
+ *
+ *                    Without options the output is the two-column
+ *                    "tau lambda" text of lambda.txt. --all writes every
+ *                    column like --stream does, --info prints the
+ *                    header. The output defaults to stdout.
+ *
+ *  Dependencies:     BinaryTrajectory.h
+ *
+ *************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/BinaryTrajectory.h"
+
+// Print header fields to ofp
+void printInfo(const BinaryTrajectory &t, FILE *ofp) {
+    const BinaryTrajectoryHeader &h = t.getHeader();
+    fprintf(ofp, "version %u, %llu steps, seed %d, run %d, %s\n", h.version,
+            (unsigned long long) t.getCount(), h.seed, h.run, h.rng);
+    fprintf(ofp, "a0=%E tau0=%E deltatau=%E V0=%E\n", h.a0, h.tau0, h.deltatau, h.V0);
+    fprintf(ofp, "rhomat0=%E rhorad0=%E lambda0=%E ell=%E\n", h.rhomat0, h.rhorad0, h.lambda0, h.ell);
+    fprintf(ofp, "columns:");
+    for (int j = 0; j < t.getColumns(); j++) {
+        fprintf(ofp, " %s", t.getName(j));
+    }
+    fprintf(ofp, "\n");
+}
+
+int main(int argc, const char * argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s input.bin [output.txt] [--all] [--info]\n", argv[0]);
+        return 1;
+    }
+    const char* input = argv[1];
+    const char* output = NULL;
+    bool all = false;
+    bool info = false;
+    for (int k = 2; k < argc; k++) {
+        if (strcmp(argv[k], "--all") == 0) {
+            all = true;
+        } else if (strcmp(argv[k], "--info") == 0) {
+            info = true;
+        } else if (argv[k][0] != '-' && output == NULL) {
+            output = argv[k];
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[k]);
+            return 1;
+        }
+    }
+
+    BinaryTrajectory t(input);
+    if (info) {
+        printInfo(t, stdout);
+        return 0;
+    }
+
+    FILE *ofp = output ? fopen(output, "w") : stdout;
+    if (ofp == NULL) {
+      fprintf(stderr, "Can't open output file %s!\n",
+              output);
+      exit(1);
+    }
+
+    uint64_t n = t.getCount();
+    if (all) {
+        int columns = t.getColumns();
+        fprintf(ofp, "#");
+        for (int j = 0; j < columns; j++) {
+            fprintf(ofp, "%s%s", j ? "\t" : " ", t.getName(j));
+        }
+        fprintf(ofp, "\n");
+        for (uint64_t i = 0; i < n; i++) {
+            for (int j = 0; j < columns; j++) {
+                fprintf(ofp, j ? "\t%E" : "%E", t.getColumn(j)[i]);
+            }
+            fprintf(ofp, "\n");
+        }
+    } else {
+        const double* tau = t.getColumn("tau");
+        const double* lambda = t.getColumn("lambda");
+        if (tau == NULL || lambda == NULL) {
+            fprintf(stderr, "%s has no tau and lambda columns!\n", input);
+            exit(1);
+        }
+        for (uint64_t i = 0; i < n; i++) {
+            fprintf(ofp, "%E\t%E\n", tau[i], lambda[i]);
+        }
+    }
+
+    if (ofp != stdout) {
+        fclose(ofp);
+    }
+    return 0;
+}